@@ -1,79 +1,9 @@
 #include <iostream>
-#include <set>
-#include <map>
-#include <queue>
+#include "nfa.h"
+#include "bit_parallel_nfa.h"
 
 using namespace std;
 
-class NFA
-{
-public:
-    map<int, map<char, set<int>>> transition;
-    int startState;
-    set<int> acceptStates;
-
-    void addTransition(int from, char symbol, int to)
-    {
-        transition[from][symbol].insert(to);
-    }
-};
-
-class DFA
-{
-public:
-    map<set<int>, map<char, set<int>>> transition;
-    set<set<int>> acceptStates;
-};
-
-DFA convertNFAtoDFA(NFA nfa, set<int> states, set<char> alphabet)
-{
-    DFA dfa;
-    queue<set<int>> q;
-    set<set<int>> dfaStates;
-
-    q.push({nfa.startState});
-    dfaStates.insert({nfa.startState});
-
-    while (!q.empty())
-    {
-        set<int> current = q.front();
-        q.pop();
-
-        for (char symbol : alphabet)
-        {
-            set<int> newState;
-            for (int state : current)
-            {
-                if (nfa.transition.count(state) && nfa.transition[state].count(symbol))
-                {
-                    newState.insert(nfa.transition[state][symbol].begin(), nfa.transition[state][symbol].end());
-                }
-            }
-
-            if (!newState.empty() && dfaStates.find(newState) == dfaStates.end())
-            {
-                dfaStates.insert(newState);
-                q.push(newState);
-            }
-            dfa.transition[current][symbol] = newState;
-        }
-    }
-
-    for (set<int> stateSet : dfaStates)
-    {
-        for (int state : stateSet)
-        {
-            if (nfa.acceptStates.count(state))
-            {
-                dfa.acceptStates.insert(stateSet);
-                break;
-            }
-        }
-    }
-
-    return dfa;
-}
-
 int main()
 {
     NFA nfa;
@@ -86,7 +16,7 @@ int main()
     nfa.addTransition(0, 'a', 1);
     nfa.addTransition(1, 'b', 2);
 
-    DFA dfa = convertNFAtoDFA(nfa, states, alphabet);
+    SubsetDFA dfa = convertNFAtoDFA(nfa, states, alphabet);
 
     cout << "DFA Transitions:\n";
     for (map<set<int>, map<char, set<int>>>::iterator it = dfa.transition.begin(); it != dfa.transition.end(); ++it)
@@ -105,5 +35,23 @@ int main()
         cout << "\n";
     }
 
+    MinimizationReport report;
+    IndexedDFA indexed = minimizeDFA(convertNFAtoDFA(IndexedNFA::fromNFA(nfa, states)), &report);
+
+    cout << "\nMinimized " << report.statesBefore << " -> " << report.statesAfter << " states";
+    cout << "\nIndexed DFA (start " << indexed.startState << "):\n";
+    for (int s = 0; s < indexed.stateCount(); s++)
+    {
+        cout << s << (indexed.accepting[s] ? "*" : " ") << " -> ";
+        for (char symbol : indexed.alphabet)
+            cout << symbol << ": " << indexed.next(s, symbol) << " ";
+        cout << "\n";
+    }
+
+    BitParallelNFA bitParallel(IndexedNFA::fromNFA(nfa, states));
+    cout << "\nBit-parallel simulation (" << bitParallel.positionCount() << " positions, " << bitParallel.kernelName() << "):\n";
+    for (string input : {"ab", "aab", "ba", "abb"})
+        cout << input << ": " << (bitParallel.isAccepted(input) ? "Accepted" : "Rejected") << "\n";
+
     return 0;
 }
\ No newline at end of file
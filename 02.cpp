@@ -1,50 +1,49 @@
 #include <iostream>
-#include <map>
-#include <set>
+#include <cstring>
+#include "dfa.h"
+#include "dfa_image.h"
 
 using namespace std;
 
-class DFA
+// Usage: 02 [--save image | --load image]
+// --save writes the compiled DFA as a binary image; --load matches with an
+// image mapped from disk instead of building the DFA.
+int main(int argc, char **argv)
 {
-public:
-    map<int, map<char, int>> transition;
-    int startState;
-    set<int> acceptStates;
-
-    void addTransition(int from, char symbol, int to)
-    {
-        transition[from][symbol] = to;
-    }
-
-    bool isAccepted(string input)
+    string input;
+    if (argc > 2 && strcmp(argv[1], "--load") == 0)
     {
-        int currentState = startState;
-        for (char symbol : input)
+        MappedDFA mapped;
+        if (!mapped.open(argv[2]))
         {
-            if (transition[currentState].count(symbol))
-            {
-                currentState = transition[currentState][symbol];
-            }
-            else
-            {
-                return false; // Invalid transition, reject input
-            }
+            cerr << "Cannot load " << argv[2] << ": " << mapped.error() << "\n";
+            return 1;
         }
-        return acceptStates.count(currentState);
+        cout << "Enter input string: ";
+        cin >> input;
+        cout << (mapped.matches(input) ? "Accepted\n" : "Rejected\n");
+        return 0;
     }
-};
 
-int main()
-{
     DFA dfa;
-    dfa.startState = 0;
-    dfa.acceptStates = {2};
+    dfa.setStartState(0);
+    dfa.addAcceptState(2);
 
     dfa.addTransition(0, 'a', 1);
     dfa.addTransition(1, 'b', 2);
     dfa.addTransition(2, 'a', 2); // Allows looping in final state
+    dfa.compile();
+
+    if (argc > 2 && strcmp(argv[1], "--save") == 0)
+    {
+        if (!saveDFAImage(dfa.compiledForm(), argv[2]))
+        {
+            cerr << "Cannot write " << argv[2] << "\n";
+            return 1;
+        }
+        return 0;
+    }
 
-    string input;
     cout << "Enter input string: ";
     cin >> input;
 
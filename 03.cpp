@@ -1,160 +1,31 @@
 #include <iostream>
-#include <sstream>
-#include <vector>
-#include <unordered_set>
-#include <unordered_map>
-#include <regex>
+#include <cstring>
+#include "token_analyzer.h"
 
 using namespace std;
 
-class TokenAnalyzer
+// Usage: 03 [--scan file [longest]]
+// With --scan the file is searched for every keyword and operator through a
+// mapping, without tokenizing, and the number of hits per word is printed.
+// Hits overlap unless `longest` asks for leftmost-longest matching.
+int main(int argc, char **argv)
 {
-private:
-    unordered_set<string> keywords = {
-        "int", "float", "double", "char", "void", "return",
-        "if", "else", "while", "for", "switch", "case",
-        "break", "continue", "const", "class", "struct", "main"};
-
-    unordered_set<string> operators = {
-        "+", "-", "*", "/", "%", "=", "==", "!=",
-        "<", ">", "<=", ">=", "&&", "||", "!",
-        "&", "|", "^", "~", "<<", ">>", "+=",
-        "-=", "*=", "/=", "%="};
-
-    unordered_set<string> punctuations = {
-        "(", ")", "{", "}", ";", ","};
-
-    vector<pair<string, string>> tokenCategories;
-
-    bool isSpecialChar(char c)
-    {
-        string specialChars = "+-*/=<>(){}[];,";
-        return specialChars.find(c) != string::npos;
-    }
-
-    vector<string> tokenize(const string &code)
-    {
-        vector<string> tokens;
-        string currentToken;
-
-        for (size_t i = 0; i < code.length(); ++i)
-        {
-            char c = code[i];
-
-            if (isspace(c))
-            {
-                if (!currentToken.empty())
-                {
-                    tokens.push_back(currentToken);
-                    currentToken.clear();
-                }
-                continue;
-            }
-
-            if (isSpecialChar(c))
-            {
-                if (!currentToken.empty())
-                {
-                    tokens.push_back(currentToken);
-                    currentToken.clear();
-                }
-                tokens.push_back(string(1, c));
-                continue;
-            }
-
-            currentToken += c;
-        }
-
-        if (!currentToken.empty())
-        {
-            tokens.push_back(currentToken);
-        }
-
-        return tokens;
-    }
-
-    string categorizeToken(const string &token)
-    {
-        if (isKeyword(token))
-            return "Keyword";
-        if (isOperator(token))
-            return "Operator";
-        if (isPunctuation(token))
-            return "Punctuation";
-        if (isIdentifier(token))
-            return "Identifier";
-        if (isNumericLiteral(token))
-            return "Numeric Literal";
-        if (isStringLiteral(token))
-            return "String Literal";
-        return "Unknown";
-    }
-
-public:
-    bool isKeyword(const string &token)
-    {
-        return keywords.find(token) != keywords.end();
-    }
-
-    bool isOperator(const string &token)
-    {
-        return operators.find(token) != operators.end();
-    }
-
-    bool isPunctuation(const string &token)
-    {
-        return punctuations.find(token) != punctuations.end();
-    }
-
-    bool isIdentifier(const string &token)
+    if (argc > 2 && strcmp(argv[1], "--scan") == 0)
     {
-        if (token.empty())
-            return false;
-
-        regex identifierPattern("^[a-zA-Z_][a-zA-Z0-9_]*$");
-        return regex_match(token, identifierPattern);
-    }
-
-    bool isNumericLiteral(const string &token)
-    {
-        regex numericPattern("^[0-9]+(\\.[0-9]+)?([eE][-+]?[0-9]+)?$");
-        return regex_match(token, numericPattern);
-    }
-
-    bool isStringLiteral(const string &token)
-    {
-        regex stringPattern("^'.'$|^\".*\"$");
-        return regex_match(token, stringPattern);
-    }
-
-    void analyzeTokens(const string &code)
-    {
-        tokenCategories.clear();
-        vector<string> tokens = tokenize(code);
-
-        for (const auto &token : tokens)
-        {
-            string category = categorizeToken(token);
-            tokenCategories.push_back({token, category});
-        }
-
-        printTokens();
-    }
-
-    void printTokens()
-    {
-        cout << "Token Analysis:\n";
-        for (const auto &p : tokenCategories)
+        const AhoCorasick &matcher = TokenAnalyzer::vocabularyMatcher();
+        AhoCorasick::Mode mode = argc > 3 && strcmp(argv[3], "longest") == 0 ? AhoCorasick::LEFTMOST_LONGEST : AhoCorasick::OVERLAPPING;
+        vector<size_t> hits(matcher.patternCount(), 0);
+        if (!matcher.scanMapped(argv[2], [&](size_t, uint32_t pattern) { hits[pattern]++; }, mode))
         {
-            auto token = p.first;
-            auto category = p.second;
-            cout << "Token: " << token << " | Category: " << category << endl;
+            cerr << "Cannot read " << argv[2] << endl;
+            return 1;
         }
+        for (uint32_t id = 0; id < hits.size(); id++)
+            if (hits[id])
+                cout << TokenAnalyzer::categoryName(TokenAnalyzer::vocabularyCategory(id)) << " " << matcher.pattern(id) << ": " << hits[id] << "\n";
+        return 0;
     }
-};
 
-int main()
-{
     TokenAnalyzer analyzer;
 
     string sampleCode = R"(
@@ -1,58 +1,72 @@
 #include <iostream>
-#include <cctype>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include "recursive_descent_parser.h"
+#include "expression_parser.h"
+#include "batch_validator.h"
+
 using namespace std;
 
-class RecursiveDescentParser
+// Usage: 05 [--pratt | [--pratt] --batch file [threads]]
+// With --pratt the whole input line is parsed by PrattParser, which accepts
+// multi-digit numbers, identifiers, - / % and unary minus, and the folded
+// expression (or the error offset) is printed. With --batch every line of
+// `file` is validated by the same parser as the single-expression mode and
+// one result per line is printed.
+int main(int argc, char **argv)
 {
-    string input;
-    int pos;
-
-    char peek() { return pos < input.length() ? input[pos] : '\0'; }
-    void advance() { pos++; }
+    string expr;
 
-    bool match(char expected)
+    bool pratt = argc > 1 && strcmp(argv[1], "--pratt") == 0;
+    int batchArg = pratt ? 2 : 1;
+    if (argc > batchArg + 1 && strcmp(argv[batchArg], "--batch") == 0)
     {
-        if (peek() == expected)
-        {
-            advance();
-            return true;
-        }
-        return false;
-    }
-
-    // Grammar Parsing Functions
-    bool E() { return T() && EPrime(); }                          // E → T E'
-    bool EPrime() { return match('+') ? T() && EPrime() : true; } // E' → + T E' | ε
-    bool T() { return F() && TPrime(); }                          // T → F T'
-    bool TPrime() { return match('*') ? F() && TPrime() : true; } // T' → * F T' | ε
-    bool F()
-    { // F → (E) | id (number)
-        if (isdigit(peek()))
+        ifstream file(argv[batchArg + 1], ios::binary);
+        if (!file)
         {
-            advance();
-            return true;
+            cerr << "Cannot open " << argv[batchArg + 1] << "\n";
+            return 1;
         }
-        if (match('('))
+        long threads = 0;
+        if (argc > batchArg + 2)
         {
-            if (E() && match(')'))
-                return true;
+            char *end;
+            errno = 0;
+            threads = strtol(argv[batchArg + 2], &end, 10);
+            if (end == argv[batchArg + 2] || *end || errno == ERANGE || threads < 1 || threads > 1024)
+            {
+                cerr << "Invalid thread count " << argv[batchArg + 2] << "\n";
+                return 1;
+            }
         }
-        return false;
+        BatchValidator validator(unsigned(threads),
+                                 pratt ? BatchValidator::PRATT : BatchValidator::RECURSIVE_DESCENT);
+        validator.validateToStream(file, cout);
+        return 0;
     }
 
-public:
-    bool parse(string expr)
+    if (pratt)
     {
-        input = expr;
-        pos = 0;
-        return E() && pos == input.length(); // Ensure complete parsing
+        PrattParser parser;
+        ExpressionTree tree;
+
+        cout << "\nEnter expression: ";
+        getline(cin, expr);
+
+        if (!parser.parse(expr, tree))
+        {
+            cout << "Invalid Expression at offset " << parser.errorOffset() << " \n\n";
+            return 0;
+        }
+        tree.foldConstants();
+        cout << "Valid Expression \n";
+        cout << "Folded: " << tree.toString() << " \n\n";
+        return 0;
     }
-};
 
-int main()
-{
     RecursiveDescentParser parser;
-    string expr;
 
     cout << "\nEnter expression: ";
     cin >> expr;
@@ -1,102 +1,89 @@
 #include <iostream>
-#include <map>
-#include <set>
-#include <vector>
+#include "ll1_parser.h"
 
 using namespace std;
 
-map<char, vector<string>> grammar; // Stores grammar rules
-map<char, set<char>> firsts, follows; // FIRST and FOLLOW sets
-set<char> nonTerminals, terminals;
-char startSymbol;
-
-// Function to compute FIRST set
-void computeFirst(char symbol) {
-    if (firsts[symbol].size() > 0) return; // Already computed
-
-    for (string production : grammar[symbol]) {
-        char firstChar = production[0];
-
-        if (terminals.count(firstChar)) {
-            firsts[symbol].insert(firstChar); // If terminal, add directly
-        } else if (nonTerminals.count(firstChar)) {
-            computeFirst(firstChar);
-            firsts[symbol].insert(firsts[firstChar].begin(), firsts[firstChar].end()); // Copy FIRST of non-terminal
-        }
-
-        if (production == "ε") {
-            firsts[symbol].insert('ε'); // If epsilon production
-        }
-    }
+// Function to print a FIRST or FOLLOW set, with ε when the nonterminal is nullable
+void printSet(const Grammar &grammar, const SymbolSet &set, bool withEpsilon) {
+    cout << "{ ";
+    set.forEach([&](uint32_t t) { cout << grammar.name(grammar.terminals[t]) << " "; });
+    if (withEpsilon) cout << "ε ";
+    cout << "}\n";
 }
 
-// Function to compute FOLLOW set
-void computeFollow(char symbol) {
-    if (follows[symbol].size() > 0) return; // Already computed
-
-    if (symbol == startSymbol) {
-        follows[symbol].insert('$'); // FOLLOW(start) = { $ }
-    }
-
-    for (auto rule : grammar) {
-        for (string production : rule.second) {
-            for (size_t i = 0; i < production.length(); i++) {
-                if (production[i] == symbol) { // If symbol found in production
-                    if (i + 1 < production.length()) {
-                        char nextChar = production[i + 1];
-                        if (terminals.count(nextChar)) {
-                            follows[symbol].insert(nextChar);
-                        } else if (nonTerminals.count(nextChar)) {
-                            follows[symbol].insert(firsts[nextChar].begin(), firsts[nextChar].end());
-                            follows[symbol].erase('ε'); // Remove epsilon
-                        }
-                    } else {
-                        follows[symbol].insert(follows[rule.first].begin(), follows[rule.first].end());
-                    }
-                }
-            }
-        }
-    }
-}
 int main() {
     int numProductions;
     cout << "Enter number of productions: ";
     cin >> numProductions;
 
+    map<string, vector<string>> rules;
     cout << "Enter grammar (e.g., A->aAb|ε):\n";
     for (int i = 0; i < numProductions; i++) {
-        char nonTerminal;
-        string arrow, production;
+        string nonTerminal, arrow, production;
         cin >> nonTerminal >> arrow >> production;
-
-        grammar[nonTerminal].push_back(production);
-        nonTerminals.insert(nonTerminal);
-        for (char ch : production) {
-            if (isupper(ch) && ch != 'ε') terminals.insert(ch);
-        }
+        rules[nonTerminal].push_back(production);
     }
 
+    string startSymbol;
     cout << "Enter start symbol: ";
     cin >> startSymbol;
 
-    // Compute FIRST and FOLLOW sets
-    for (char nt : nonTerminals) computeFirst(nt);
-    for (char nt : nonTerminals) computeFollow(nt);
+    // Intern the grammar and compute FIRST and FOLLOW sets
+    Grammar grammar = Grammar::fromRules(rules, startSymbol);
+    FirstFollowSets sets = computeFirstFollowSets(grammar);
 
     // Print FIRST sets
     cout << "\nFIRST sets:\n";
-    for (auto &pair : firsts) {
-        cout << "FIRST(" << pair.first << ") = { ";
-        for (char ch : pair.second) cout << ch << " ";
-        cout << "}\n";
+    for (uint32_t i = 0; i < grammar.nonTerminalCount(); i++) {
+        cout << "FIRST(" << grammar.name(grammar.nonTerminals[i]) << ") = ";
+        printSet(grammar, sets.first[i], sets.nullable[i]);
     }
 
     // Print FOLLOW sets
     cout << "\nFOLLOW sets:\n";
-    for (auto &pair : follows) {
-        cout << "FOLLOW(" << pair.first << ") = { ";
-        for (char ch : pair.second) cout << ch << " ";
-        cout << "}\n";
+    for (uint32_t i = 0; i < grammar.nonTerminalCount(); i++) {
+        cout << "FOLLOW(" << grammar.name(grammar.nonTerminals[i]) << ") = ";
+        printSet(grammar, sets.follow[i], false);
+    }
+
+    // Build and print the LL(1) parse table
+    LL1Table table = buildLL1Table(grammar, sets);
+    cout << "\nLL(1) parse table:\n";
+    for (uint32_t row = 0; row < grammar.nonTerminalCount(); row++) {
+        for (uint32_t column = 0; column < table.columns; column++) {
+            int32_t number = table.cell(row, column);
+            if (number < 0) continue;
+            cout << "M[" << grammar.name(grammar.nonTerminals[row]) << ", " << grammar.name(grammar.terminals[column])
+                 << "] = " << grammar.productionText(number, "") << "\n";
+        }
+    }
+    for (const LL1Conflict &conflict : table.conflicts) {
+        cout << "Conflict at M[" << grammar.name(grammar.nonTerminals[conflict.nonTerminal]) << ", "
+             << grammar.name(grammar.terminals[conflict.terminal]) << "]: " << grammar.productionText(conflict.existing, "")
+             << " vs " << grammar.productionText(conflict.incoming, "") << "\n";
+    }
+    cout << (table.isLL1() ? "Grammar is LL(1)\n" : "Grammar is not LL(1)\n");
+
+    // Parse an input string with the table, one character per terminal
+    if (!table.isLL1()) {
+        cout << "\nSkipping parsing: the table has conflicts\n";
+        return 0;
+    }
+    string input;
+    cout << "\nEnter string to parse: ";
+    if (cin >> input) {
+        vector<uint32_t> tokens;
+        size_t errorPos = 0;
+        for (; errorPos < input.size(); errorPos++) {
+            uint32_t id = grammar.find(input.substr(errorPos, 1));
+            if (id == UINT32_MAX || grammar.isNonTerminal[id] || id == Grammar::endMarker) break;
+            tokens.push_back(id);
+        }
+        if (tokens.size() == input.size() && predictiveParse(grammar, table, tokens, nullptr, &errorPos)) {
+            cout << "String accepted\n";
+        } else {
+            cout << "String rejected at position " << errorPos << "\n";
+        }
     }
 
     return 0;
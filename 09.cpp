@@ -0,0 +1,61 @@
+#include <iostream>
+#include "lalr_parser.h"
+
+using namespace std;
+
+int main() {
+    int numProductions;
+    cout << "Enter number of productions: ";
+    cin >> numProductions;
+
+    map<string, vector<string>> rules;
+    cout << "Enter grammar (e.g., E -> E+T):\n";
+    for (int i = 0; i < numProductions; i++) {
+        string nonTerminal, arrow, production;
+        cin >> nonTerminal >> arrow >> production;
+        rules[nonTerminal].push_back(production);
+    }
+
+    string startSymbol;
+    cout << "Enter start symbol: ";
+    cin >> startSymbol;
+
+    // Build the LALR(1) tables
+    Grammar grammar = Grammar::fromRules(rules, startSymbol);
+    LALRTable table = buildLALRTable(grammar, computeFirstFollowSets(grammar));
+
+    cout << "\nLALR(1) automaton: " << table.stateCount << " states\n";
+    cout << "Compressed ACTION: " << table.action.bytes() << " bytes, GOTO: " << table.gotoTable.bytes() << " bytes (dense: "
+         << table.stateCount * (grammar.terminalCount() + grammar.nonTerminalCount()) * sizeof(int32_t) << " bytes)\n";
+    for (const LALRConflict &conflict : table.conflicts) {
+        auto describe = [&](int32_t action) {
+            if (action > 0) return "shift " + to_string(action - 1);
+            if (uint32_t(-action - 1) == table.accepting) return string("accept");
+            return "reduce " + grammar.productionText(-action - 1, "");
+        };
+        cout << "Conflict in state " << conflict.state << " on " << grammar.name(grammar.terminals[conflict.terminal]) << ": "
+             << describe(conflict.kept) << " over " << describe(conflict.dropped) << "\n";
+    }
+    cout << (table.isLALR1() ? "Grammar is LALR(1)\n" : "Grammar is not LALR(1)\n");
+
+    // Parse an input string with the tables, one character per terminal
+    string input;
+    cout << "\nEnter string to parse: ";
+    if (cin >> input) {
+        vector<uint32_t> tokens, reductions;
+        size_t errorPos = 0;
+        for (; errorPos < input.size(); errorPos++) {
+            uint32_t id = grammar.find(input.substr(errorPos, 1));
+            if (id == UINT32_MAX || grammar.isNonTerminal[id] || id == Grammar::endMarker) break;
+            tokens.push_back(id);
+        }
+        if (tokens.size() == input.size() && lalrParse(grammar, table, tokens, &reductions, &errorPos)) {
+            cout << "String accepted\nReductions:\n";
+            for (uint32_t p : reductions) cout << "  " << grammar.productionText(p, "") << "\n";
+        } else {
+            cout << "String rejected at position " << errorPos << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Multi-pattern matcher: an Aho-Corasick automaton with the failure links
+// folded into a dense state x byte-class transition table, so every input
+// byte costs exactly one table lookup. Matches are reported to a callback as
+// (offset of the first byte, pattern id), where the id is the pattern's index
+// in the constructor's list; nothing is allocated per match.
+class AhoCorasick
+{
+public:
+    enum Mode : uint8_t
+    {
+        OVERLAPPING,      // every occurrence of every pattern, by end offset
+        LEFTMOST_LONGEST, // non-overlapping, left to right, longest at each start
+    };
+
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    AhoCorasick() : AhoCorasick(std::vector<std::string_view>{}) {}
+
+    // Empty patterns never match; a repeated pattern reports its first id.
+    explicit AhoCorasick(const std::vector<std::string_view> &patterns)
+    {
+        for (std::string_view pattern : patterns)
+        {
+            patternStart.push_back(text.size());
+            text += pattern;
+        }
+        patternStart.push_back(text.size());
+
+        // Bytes that occur in no pattern share class 0
+        byteClass.fill(0);
+        for (unsigned char c : text)
+            byteClass[c] = 1;
+        classCount = 1;
+        for (int b = 0; b < 256; b++)
+            if (byteClass[b])
+                byteClass[b] = classCount++;
+
+        // Trie; missing edges are NONE until the failure pass fills them in
+        auto addState = [&](uint32_t stateDepth)
+        {
+            next.resize(next.size() + classCount, NONE);
+            output.push_back(NONE);
+            depth.push_back(stateDepth);
+            return uint32_t(depth.size() - 1);
+        };
+        addState(0);
+        for (uint32_t id = 0; id < patterns.size(); id++)
+        {
+            uint32_t state = 0;
+            for (unsigned char c : patterns[id])
+            {
+                size_t edge = state * classCount + byteClass[c];
+                if (next[edge] == NONE)
+                {
+                    uint32_t child = addState(depth[state] + 1);
+                    next[edge] = child;
+                }
+                state = next[edge];
+            }
+            if (state != 0 && output[state] == NONE)
+                output[state] = id;
+        }
+
+        // Breadth-first failure links; a missing edge becomes the failure
+        // state's edge, and dictionary links skip to the nearest suffix state
+        // with an output
+        size_t states = depth.size();
+        std::vector<uint32_t> fail(states, 0), queue;
+        dictionary.assign(states, 0);
+        longest.assign(states, NONE);
+        for (uint32_t c = 0; c < classCount; c++)
+        {
+            uint32_t &edge = next[c];
+            if (edge == NONE)
+                edge = 0;
+            else
+                queue.push_back(edge);
+        }
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            uint32_t state = queue[head];
+            uint32_t suffix = fail[state];
+            dictionary[state] = output[suffix] != NONE ? suffix : dictionary[suffix];
+            longest[state] = output[state] != NONE ? output[state] : longest[suffix];
+            for (uint32_t c = 0; c < classCount; c++)
+            {
+                uint32_t &edge = next[state * classCount + c];
+                if (edge == NONE)
+                {
+                    edge = next[suffix * classCount + c];
+                }
+                else
+                {
+                    fail[edge] = next[suffix * classCount + c];
+                    queue.push_back(edge);
+                }
+            }
+        }
+    }
+
+    size_t patternCount() const { return patternStart.size() - 1; }
+    size_t stateCount() const { return depth.size(); }
+
+    std::string_view pattern(uint32_t id) const
+    {
+        return std::string_view(text).substr(patternStart[id], patternStart[id + 1] - patternStart[id]);
+    }
+
+    // Reports matches in `input` through visit(size_t offset, uint32_t pattern)
+    // and returns how many there were. OVERLAPPING reports every occurrence in
+    // order of its end offset. LEFTMOST_LONGEST keeps the longest match at the
+    // leftmost start and resumes after it; a match is reported once no live
+    // trie prefix starts at or before it, and scanning resumes from its end,
+    // so each match costs at most one rescan of the longest pattern's length.
+    template <typename Visit>
+    size_t scan(std::string_view input, Visit visit, Mode mode = OVERLAPPING) const
+    {
+        const uint32_t *table = next.data();
+        const uint16_t *classes = byteClass.data();
+        const unsigned char *bytes = (const unsigned char *)input.data();
+        size_t n = input.size(), matches = 0;
+        uint32_t state = 0;
+
+        if (mode == OVERLAPPING)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                state = table[state * classCount + classes[bytes[i]]];
+                if (longest[state] == NONE)
+                    continue;
+                for (uint32_t s = output[state] != NONE ? state : dictionary[state]; s != 0; s = dictionary[s])
+                {
+                    visit(i + 1 - depth[s], output[s]);
+                    matches++;
+                }
+            }
+            return matches;
+        }
+
+        const size_t noMatch = SIZE_MAX;
+        size_t i = 0, start = noMatch;
+        uint32_t id = NONE;
+        while (true)
+        {
+            if (i < n)
+            {
+                state = table[state * classCount + classes[bytes[i++]]];
+                uint32_t found = longest[state];
+                if (found != NONE && i - length(found) <= start) // same start and later end means longer
+                {
+                    start = i - length(found);
+                    id = found;
+                }
+                if (start == noMatch || start >= i - depth[state])
+                    continue;
+            }
+            else if (start == noMatch)
+            {
+                break;
+            }
+            visit(start, id);
+            matches++;
+            i = start + length(id);
+            state = 0;
+            start = noMatch;
+        }
+        return matches;
+    }
+
+    // Scans a whole file through a read-only mapping; offsets are file
+    // offsets. Returns false if the file cannot be opened or mapped.
+    template <typename Visit>
+    bool scanMapped(const std::string &path, Visit visit, Mode mode = OVERLAPPING) const
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) < 0)
+        {
+            close(fd);
+            return false;
+        }
+        size_t size = info.st_size;
+        if (size == 0)
+        {
+            close(fd);
+            return true;
+        }
+
+        void *base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED)
+            return false;
+        madvise(base, size, MADV_SEQUENTIAL);
+        scan(std::string_view((const char *)base, size), visit, mode);
+        munmap(base, size);
+        return true;
+    }
+
+private:
+    std::string text;                  // all patterns back to back
+    std::vector<size_t> patternStart;  // pattern i is text[patternStart[i], patternStart[i + 1])
+    std::array<uint16_t, 256> byteClass;
+    uint32_t classCount = 1;
+    std::vector<uint32_t> next;        // stateCount() x classCount, failure links folded in
+    std::vector<uint32_t> output;      // pattern ending exactly at the state, or NONE
+    std::vector<uint32_t> dictionary;  // nearest proper suffix state with an output, 0 if none
+    std::vector<uint32_t> longest;     // longest pattern that is a suffix of the state, or NONE
+    std::vector<uint32_t> depth;       // length of the state's string
+
+    size_t length(uint32_t id) const { return patternStart[id + 1] - patternStart[id]; }
+};
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "recursive_descent_parser.h"
+#include "expression_parser.h"
+
+// Validates newline-delimited expressions in bulk. A reader thread cuts the
+// input into batches of whole lines, a pool of workers parses them (each with
+// its own parser, reused across lines) and the calling thread receives the
+// per-line results in input order. Batches come from a
+// fixed pool that is recycled once a batch has been emitted, so memory stays
+// at about batchBytes * maxInFlight however large the input is.
+class BatchValidator
+{
+public:
+    // RECURSIVE_DESCENT accepts what 05 accepts by default (single digits,
+    // + * and parentheses, nested at most RecursiveDescentParser::maxNesting
+    // deep); PRATT is the --pratt grammar.
+    enum Grammar
+    {
+        RECURSIVE_DESCENT,
+        PRATT
+    };
+
+    struct LineResult
+    {
+        bool valid;
+        uint32_t errorOffset; // byte offset within the line, 0 when valid
+    };
+
+private:
+    struct Batch
+    {
+        size_t sequence;
+        size_t firstLine;
+        std::string text; // whole lines, each ending in '\n'
+        std::vector<LineResult> results;
+    };
+
+    unsigned threadCount;
+    Grammar grammar;
+    size_t batchBytes;
+    size_t maxInFlight;
+
+    struct Parsers
+    {
+        RecursiveDescentParser recursiveDescent;
+        PrattParser pratt;
+        ExpressionTree tree;
+    };
+
+    void validateBatch(Batch &batch, Parsers &parsers) const
+    {
+        batch.results.clear();
+        std::string_view text = batch.text;
+        for (size_t start = 0, end; start < text.size(); start = end + 1)
+        {
+            end = text.find('\n', start);
+            std::string_view line = text.substr(start, end - start);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            bool valid;
+            size_t errorOffset;
+            if (grammar == PRATT)
+            {
+                valid = parsers.pratt.parse(line, parsers.tree);
+                errorOffset = parsers.pratt.errorOffset();
+            }
+            else
+            {
+                valid = parsers.recursiveDescent.parse(line);
+                errorOffset = parsers.recursiveDescent.errorOffset();
+            }
+            batch.results.push_back({valid, valid ? 0 : uint32_t(errorOffset)});
+        }
+    }
+
+public:
+    BatchValidator(unsigned threadCount = 0, Grammar grammar = RECURSIVE_DESCENT,
+                   size_t batchBytes = 1 << 20, size_t maxInFlight = 0)
+        : threadCount(threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency())),
+          grammar(grammar),
+          batchBytes(std::max<size_t>(batchBytes, 1)),
+          maxInFlight(maxInFlight ? maxInFlight : 2 * this->threadCount + 2)
+    {
+    }
+
+    // Calls visit(lineNumber, result) for every line of `in`, in order, on the
+    // calling thread. Line numbers start at 1. Returns the number of lines.
+    template <typename Visit>
+    size_t validate(std::istream &in, Visit visit)
+    {
+        std::mutex lock;
+        std::condition_variable batchFree, batchReady, batchDone;
+        std::vector<std::unique_ptr<Batch>> pool;
+        std::vector<Batch *> idle;
+        std::deque<Batch *> pending;
+        std::map<size_t, Batch *> done; // reorder buffer
+        bool readerFinished = false;
+        size_t batchesRead = 0;
+
+        for (size_t i = 0; i < maxInFlight; i++)
+        {
+            pool.push_back(std::make_unique<Batch>());
+            idle.push_back(pool.back().get());
+        }
+
+        std::thread reader([&]
+                      {
+                          std::string carry;
+                          size_t line = 1;
+                          std::vector<char> chunk(batchBytes);
+                          while (true)
+                          {
+                              in.read(chunk.data(), chunk.size());
+                              size_t got = in.gcount();
+                              bool atEnd = got < chunk.size();
+                              size_t carried = carry.size(); // holds no '\n', so only new bytes are searched
+                              carry.append(chunk.data(), got);
+                              size_t cut = atEnd ? carry.size() : std::string_view(carry).substr(carried).rfind('\n');
+                              if (cut == std::string::npos)
+                                  continue; // one line longer than a chunk: keep reading
+                              if (!atEnd)
+                                  cut += carried + 1;
+                              if (cut > 0)
+                              {
+                                  Batch *batch;
+                                  {
+                                      std::unique_lock<std::mutex> guard(lock);
+                                      batchFree.wait(guard, [&] { return !idle.empty(); });
+                                      batch = idle.back();
+                                      idle.pop_back();
+                                  }
+                                  batch->text.assign(carry, 0, cut);
+                                  if (batch->text.back() != '\n')
+                                      batch->text += '\n'; // unterminated last line
+                                  batch->firstLine = line;
+                                  for (char c : batch->text)
+                                      line += c == '\n';
+                                  carry.erase(0, cut);
+                                  std::lock_guard<std::mutex> guard(lock);
+                                  batch->sequence = batchesRead++;
+                                  pending.push_back(batch);
+                                  batchReady.notify_one();
+                              }
+                              if (atEnd)
+                                  break;
+                          }
+                          std::lock_guard<std::mutex> guard(lock);
+                          readerFinished = true;
+                          batchReady.notify_all();
+                          batchDone.notify_all();
+                      });
+
+        std::vector<std::thread> workers;
+        for (unsigned w = 0; w < threadCount; w++)
+        {
+            workers.emplace_back([&]
+                                 {
+                                     Parsers parsers;
+                                     while (true)
+                                     {
+                                         Batch *batch;
+                                         {
+                                             std::unique_lock<std::mutex> guard(lock);
+                                             batchReady.wait(guard, [&] { return !pending.empty() || readerFinished; });
+                                             if (pending.empty())
+                                                 return;
+                                             batch = pending.front();
+                                             pending.pop_front();
+                                         }
+                                         validateBatch(*batch, parsers);
+                                         std::lock_guard<std::mutex> guard(lock);
+                                         done[batch->sequence] = batch;
+                                         batchDone.notify_all();
+                                     }
+                                 });
+        }
+
+        size_t lines = 0;
+        for (size_t next = 0;; next++)
+        {
+            Batch *batch;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                batchDone.wait(guard, [&] { return done.count(next) || (readerFinished && next == batchesRead); });
+                if (!done.count(next))
+                    break;
+                batch = done[next];
+                done.erase(next);
+            }
+            for (size_t i = 0; i < batch->results.size(); i++)
+                visit(batch->firstLine + i, batch->results[i]);
+            lines += batch->results.size();
+            std::lock_guard<std::mutex> guard(lock);
+            idle.push_back(batch);
+            batchFree.notify_one();
+        }
+
+        reader.join();
+        for (std::thread &worker : workers)
+            worker.join();
+        return lines;
+    }
+
+    // Writes "<line> valid" or "<line> invalid <offset>" for every line of
+    // `in` to `out`. Returns the number of invalid lines.
+    size_t validateToStream(std::istream &in, std::ostream &out)
+    {
+        size_t invalid = 0;
+        std::string buffer;
+        validate(in, [&](size_t line, LineResult result)
+                 {
+                     buffer += std::to_string(line);
+                     if (result.valid)
+                         buffer += " valid\n";
+                     else
+                     {
+                         buffer += " invalid " + std::to_string(result.errorOffset) + "\n";
+                         invalid++;
+                     }
+                     if (buffer.size() >= (1 << 16))
+                     {
+                         out << buffer;
+                         buffer.clear();
+                     }
+                 });
+        out << buffer;
+        return invalid;
+    }
+};
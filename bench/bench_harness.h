@@ -0,0 +1,210 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <thread>
+#include "platform.h"
+
+// Per-iteration work a benchmark reports, used for throughput figures.
+struct BenchCounters
+{
+    double bytes = 0;
+    double items = 0;
+};
+
+struct BenchCase
+{
+    std::string name;
+    std::vector<std::pair<std::string, long long>> params;
+    // Runs untimed setup and returns the body to time.
+    std::function<std::function<void()>(BenchCounters &)> setup;
+};
+
+struct BenchResult
+{
+    const BenchCase *benchCase;
+    long long iterations;
+    double nsPerOp;
+    double cyclesPerOp;
+    BenchCounters counters;
+};
+
+// Sink for benchmark results so the optimizer cannot drop the work.
+inline volatile uint64_t benchSink;
+
+template <typename T>
+inline void keep(const T &value)
+{
+    benchSink = benchSink + (uint64_t)value;
+}
+
+// Minimal runner: every case is repeated with doubling iteration counts
+// until one batch runs for at least minSeconds, then timed per iteration.
+class BenchSuite
+{
+    std::vector<BenchCase> cases;
+
+    static uint64_t cycles()
+    {
+#ifdef CDLAB_X86
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    static std::string escape(const std::string &text)
+    {
+        std::string out;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            out += c;
+        }
+        return out;
+    }
+
+public:
+    void add(std::string name, std::vector<std::pair<std::string, long long>> params, std::function<std::function<void()>(BenchCounters &)> setup)
+    {
+        cases.push_back({std::move(name), std::move(params), std::move(setup)});
+    }
+
+    static std::string fullName(const BenchCase &c)
+    {
+        std::string name = c.name;
+        for (const auto &p : c.params)
+            name += "/" + p.first + ":" + std::to_string(p.second);
+        return name;
+    }
+
+    BenchResult run(const BenchCase &c, double minSeconds) const
+    {
+        BenchResult result{&c, 0, 0, 0, {}};
+        std::function<void()> body = c.setup(result.counters);
+        body(); // warm-up
+
+        for (long long iterations = 1;; iterations *= 2)
+        {
+            uint64_t startCycles = cycles();
+            auto start = std::chrono::steady_clock::now();
+            for (long long i = 0; i < iterations; i++)
+                body();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            uint64_t elapsedCycles = cycles() - startCycles;
+            if (seconds >= minSeconds || iterations >= (1LL << 40))
+            {
+                result.iterations = iterations;
+                result.nsPerOp = seconds * 1e9 / iterations;
+                result.cyclesPerOp = double(elapsedCycles) / iterations;
+                return result;
+            }
+        }
+    }
+
+    static std::string toJson(const std::vector<BenchResult> &results)
+    {
+        std::ostringstream out;
+        time_t now = time(nullptr);
+        char date[32];
+        strftime(date, sizeof date, "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+        out << "{\n  \"context\": {\n"
+            << "    \"date\": \"" << date << "\",\n"
+            << "    \"compiler\": \"" << escape(__VERSION__) << "\",\n"
+            << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+            << "    \"build\": \"release\"\n"
+#else
+            << "    \"build\": \"debug\"\n"
+#endif
+            << "  },\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const BenchResult &r = results[i];
+            double seconds = r.nsPerOp * 1e-9;
+            out << (i ? "," : "") << "\n    {\"name\": \"" << escape(fullName(*r.benchCase)) << "\", \"params\": {";
+            for (size_t p = 0; p < r.benchCase->params.size(); p++)
+                out << (p ? ", " : "") << "\"" << escape(r.benchCase->params[p].first) << "\": " << r.benchCase->params[p].second;
+            out << "}, \"iterations\": " << r.iterations << ", \"ns_per_op\": " << r.nsPerOp;
+            if (r.cyclesPerOp > 0)
+                out << ", \"cycles_per_op\": " << r.cyclesPerOp;
+            if (r.counters.bytes > 0)
+            {
+                out << ", \"bytes_per_second\": " << r.counters.bytes / seconds;
+                if (r.cyclesPerOp > 0)
+                    out << ", \"bytes_per_cycle\": " << r.counters.bytes / r.cyclesPerOp;
+            }
+            if (r.counters.items > 0)
+                out << ", \"items_per_second\": " << r.counters.items / seconds;
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+        return out.str();
+    }
+
+    // Usage: [--filter substring] [--min-time seconds] [--json path] [--list]
+    int main(int argc, char **argv) const
+    {
+        std::string filter, jsonPath;
+        double minSeconds = 0.2;
+        bool listOnly = false;
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--filter" && i + 1 < argc)
+                filter = argv[++i];
+            else if (arg == "--min-time" && i + 1 < argc)
+                minSeconds = std::stod(argv[++i]);
+            else if (arg == "--json" && i + 1 < argc)
+                jsonPath = argv[++i];
+            else if (arg == "--list")
+                listOnly = true;
+            else
+            {
+                std::cerr << "Usage: " << argv[0] << " [--filter substring] [--min-time seconds] [--json path] [--list]\n";
+                return 1;
+            }
+        }
+
+        std::vector<BenchResult> results;
+        for (const BenchCase &c : cases)
+        {
+            std::string name = fullName(c);
+            if (!filter.empty() && name.find(filter) == std::string::npos)
+                continue;
+            if (listOnly)
+            {
+                std::cout << name << "\n";
+                continue;
+            }
+            results.push_back(run(c, minSeconds));
+            std::cerr << name << ": " << results.back().nsPerOp << " ns/op\n";
+        }
+        if (listOnly)
+            return 0;
+
+        std::string json = toJson(results);
+        if (jsonPath.empty())
+        {
+            std::cout << json;
+            return 0;
+        }
+        std::ofstream file(jsonPath);
+        file << json;
+        if (!file)
+        {
+            std::cerr << "Cannot write " << jsonPath << "\n";
+            return 1;
+        }
+        return 0;
+    }
+};
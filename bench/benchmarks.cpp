@@ -0,0 +1,667 @@
+#include <iostream>
+#include <unordered_set>
+#include "bench_harness.h"
+#include "corpus.h"
+#include "nfa.h"
+#include "dfa.h"
+#include "dfa_image.h"
+#include "bit_parallel_nfa.h"
+#include "token_analyzer.h"
+#include "lexical_analyzer.h"
+#include "incremental_lexer.h"
+#include "recursive_descent_parser.h"
+#include "expression_parser.h"
+#include "batch_validator.h"
+#include "left_factoring.h"
+#include "left_recursion.h"
+#include "first_follow.h"
+#include "ll1_parser.h"
+#include "lalr_parser.h"
+#include "dfa16_switch.h"
+#include "dfa16_table.h"
+#include "dfa1024_switch.h"
+#include "dfa1024_table.h"
+
+using namespace std;
+
+// Discards everything written to cout while in scope, for the tools that
+// print their results instead of returning them.
+class MuteCout
+{
+    struct NullBuffer : streambuf
+    {
+        int overflow(int c) override { return c; }
+    };
+    NullBuffer null;
+    streambuf *saved;
+
+public:
+    MuteCout() : saved(cout.rdbuf(&null)) {}
+    ~MuteCout() { cout.rdbuf(saved); }
+};
+
+const uint64_t seed = 42;
+
+void addAutomataBenchmarks(BenchSuite &suite)
+{
+    for (int states : {16, 1024})
+    {
+        for (bool compiled : {false, true})
+        {
+            suite.add(compiled ? "DFA::isAccepted/compiled" : "DFA::isAccepted/map", {{"states", states}, {"length", 4096}},
+                      [=](BenchCounters &counters)
+                      {
+                          auto dfa = make_shared<DFA>(generateDFA(states, 4, seed));
+                          if (compiled)
+                              dfa->compile();
+                          auto input = make_shared<string>(generateDFAInput(4096, 4, seed));
+                          counters.bytes = input->size();
+                          return [=]() { keep(dfa->isAccepted(*input)); };
+                      });
+        }
+    }
+
+    // Matchers generated at build time from the same DFAs (see bench/CMakeLists.txt)
+    for (int states : {16, 1024})
+    {
+        for (bool useSwitch : {true, false})
+        {
+            bool (*matcher)(string_view) = states == 16 ? (useSwitch ? matchDFA16_switch : matchDFA16_table)
+                                                        : (useSwitch ? matchDFA1024_switch : matchDFA1024_table);
+            suite.add(useSwitch ? "DFA::isAccepted/generated-switch" : "DFA::isAccepted/generated-table",
+                      {{"states", states}, {"length", 4096}}, [=](BenchCounters &counters)
+                      {
+                          auto input = make_shared<string>(generateDFAInput(4096, 4, seed));
+                          counters.bytes = input->size();
+                          return [=]() { keep(matcher(*input)); };
+                      });
+        }
+    }
+
+    for (int patterns : {64, 512})
+    {
+        suite.add("convertNFAtoDFA/set", {{"patterns", patterns}}, [=](BenchCounters &counters)
+                  {
+                      auto states = make_shared<set<int>>();
+                      auto alphabet = make_shared<set<char>>();
+                      auto nfa = make_shared<NFA>(toMapNFA(generatePatternUnionNFA(patterns, 8, seed, false), *states, *alphabet));
+                      counters.items = states->size();
+                      return [=]() { keep(convertNFAtoDFA(*nfa, *states, *alphabet).transition.size()); };
+                  });
+    }
+
+    for (int patterns : {64, 512, 4096})
+    {
+        suite.add("convertNFAtoDFA/bitset", {{"patterns", patterns}}, [=](BenchCounters &counters)
+                  {
+                      auto nfa = make_shared<IndexedNFA>(generatePatternUnionNFA(patterns, 8, seed));
+                      counters.items = nfa->stateCount();
+                      return [=]() { keep(convertNFAtoDFA(*nfa).stateCount()); };
+                  });
+        suite.add("convertNFAtoDFAParallel", {{"patterns", patterns}, {"threads", thread::hardware_concurrency()}},
+                  [=](BenchCounters &counters)
+                  {
+                      auto nfa = make_shared<IndexedNFA>(generatePatternUnionNFA(patterns, 8, seed));
+                      counters.items = nfa->stateCount();
+                      return [=]() { keep(convertNFAtoDFAParallel(*nfa).stateCount()); };
+                  });
+    }
+
+    for (int k : {10, 14})
+    {
+        suite.add("convertNFAtoDFA/bitset-suffix", {{"k", k}}, [=](BenchCounters &)
+                  {
+                      auto nfa = make_shared<IndexedNFA>(generateSuffixNFA(k));
+                      return [=]() { keep(convertNFAtoDFA(*nfa).stateCount()); };
+                  });
+        suite.add("minimizeDFA/suffix", {{"k", k}}, [=](BenchCounters &counters)
+                  {
+                      auto dfa = make_shared<IndexedDFA>(convertNFAtoDFA(generateSuffixNFA(k)));
+                      counters.items = dfa->stateCount();
+                      return [=]() { keep(minimizeDFA(*dfa).stateCount()); };
+                  });
+    }
+
+    suite.add("minimizeDFA/patterns", {{"patterns", 4096}}, [](BenchCounters &counters)
+              {
+                  auto dfa = make_shared<IndexedDFA>(convertNFAtoDFA(generatePatternUnionNFA(4096, 8, seed)));
+                  counters.items = dfa->stateCount();
+                  return [=]() { keep(minimizeDFA(*dfa).stateCount()); };
+              });
+
+    // Cold start: rebuilding a large automaton against mapping its saved image
+    suite.add("CompiledDFA/build", {{"patterns", 4096}}, [](BenchCounters &counters)
+              {
+                  auto nfa = make_shared<IndexedNFA>(generatePatternUnionNFA(4096, 8, seed));
+                  counters.items = nfa->stateCount();
+                  return [=]() { keep(minimizeDFA(convertNFAtoDFA(*nfa)).compile().stateCount); };
+              });
+    for (bool verify : {true, false})
+    {
+        suite.add(verify ? "MappedDFA::open/verified" : "MappedDFA::open/unverified", {{"patterns", 4096}},
+                  [=](BenchCounters &counters)
+                  {
+                      // The image is removed when the body is destroyed
+                      shared_ptr<string> path(new string("/tmp/cdlab_bench_" + to_string(getpid()) + ".dfa"), [](string *p)
+                                              {
+                                                  remove(p->c_str());
+                                                  delete p;
+                                              });
+                      CompiledDFA compiled = minimizeDFA(convertNFAtoDFA(generatePatternUnionNFA(4096, 8, seed))).compile();
+                      if (!saveDFAImage(compiled, *path))
+                          cerr << "Cannot write " << *path << "\n";
+                      counters.bytes = compiled.table.size() * sizeof(int32_t);
+                      auto mapped = make_shared<MappedDFA>();
+                      return [=]()
+                      {
+                          keep(mapped->open(*path, verify) && mapped->matches("abc"));
+                          mapped->close();
+                      };
+                  });
+    }
+    suite.add("MappedDFA::matches", {{"states", 1024}, {"length", 4096}}, [](BenchCounters &counters)
+              {
+                  string path = "/tmp/cdlab_bench_" + to_string(getpid()) + ".dfa";
+                  DFA dfa = generateDFA(1024, 4, seed);
+                  dfa.compile();
+                  auto mapped = make_shared<MappedDFA>();
+                  if (!saveDFAImage(dfa.compiledForm(), path) || !mapped->open(path))
+                      cerr << "Cannot map " << path << "\n";
+                  remove(path.c_str()); // the mapping outlives the name
+                  auto input = make_shared<string>(generateDFAInput(4096, 4, seed));
+                  counters.bytes = input->size();
+                  return [=]() { keep(mapped->matches(*input)); };
+              });
+
+    for (int budget : {4 << 10, 1 << 20})
+    {
+        suite.add("LazyDFA::isAccepted/suffix", {{"k", 20}, {"budget", budget}, {"length", 65536}}, [=](BenchCounters &counters)
+                  {
+                      auto nfa = make_shared<IndexedNFA>(generateSuffixNFA(20));
+                      auto lazy = make_shared<LazyDFA>(*nfa, budget);
+                      auto input = make_shared<string>(generateDFAInput(65536, 2, seed));
+                      counters.bytes = input->size();
+                      return [nfa, lazy, input]() { keep(lazy->isAccepted(*input)); }; // lazy refers to *nfa
+                  });
+    }
+
+    // 2k + 2 Glushkov positions: k = 20, 60 and 120 hit the 64-, 128- and
+    // 256-bit kernels and 200 the word-array one; k = 10 against its DFA
+    suite.add("IndexedDFA::isAccepted/suffix", {{"k", 10}, {"length", 65536}}, [](BenchCounters &counters)
+              {
+                  auto dfa = make_shared<IndexedDFA>(convertNFAtoDFA(generateSuffixNFA(10)));
+                  auto input = make_shared<string>(generateDFAInput(65536, 2, seed));
+                  counters.bytes = input->size();
+                  return [=]() { keep(dfa->isAccepted(*input)); };
+              });
+    for (int k : {10, 20, 60, 120, 200})
+    {
+        suite.add("BitParallelNFA::isAccepted/suffix", {{"k", k}, {"length", 65536}}, [=](BenchCounters &counters)
+                  {
+                      auto matcher = make_shared<BitParallelNFA>(generateSuffixNFA(k));
+                      auto input = make_shared<string>(generateDFAInput(65536, 2, seed));
+                      counters.bytes = input->size();
+                      return [=]() { keep(matcher->isAccepted(*input)); };
+                  });
+    }
+}
+
+void addLexerBenchmarks(BenchSuite &suite)
+{
+    for (int kb : {64, 1024})
+    {
+        suite.add("TokenAnalyzer::analyzeTokens", {{"kb", kb}}, [=](BenchCounters &counters)
+                  {
+                      auto analyzer = make_shared<TokenAnalyzer>();
+                      auto code = make_shared<string>(generateSource(kb << 10, seed));
+                      counters.bytes = code->size();
+                      return [=]()
+                      {
+                          MuteCout mute;
+                          analyzer->analyzeTokens(*code);
+                      };
+                  });
+        suite.add("TokenAnalyzer::tokenize", {{"kb", kb}}, [=](BenchCounters &counters)
+                  {
+                      auto analyzer = make_shared<TokenAnalyzer>();
+                      auto code = make_shared<string>(generateSource(kb << 10, seed));
+                      counters.bytes = code->size();
+                      return [=]()
+                      {
+                          analyzer->tokenize(*code);
+                          keep(analyzer->tokenBuffer().size());
+                      };
+                  });
+        suite.add("LexicalAnalyzer::analyze", {{"kb", kb}}, [=](BenchCounters &counters)
+                  {
+                      auto lexer = make_shared<LexicalAnalyzer>();
+                      auto code = make_shared<string>(generateSource(kb << 10, seed));
+                      counters.bytes = code->size();
+                      return [=]()
+                      {
+                          lexer->analyze(*code);
+                          keep(lexer->tokenBuffer().size());
+                      };
+                  });
+        suite.add("LexicalAnalyzer::analyzeParallel", {{"kb", kb}, {"threads", thread::hardware_concurrency()}},
+                  [=](BenchCounters &counters)
+                  {
+                      auto lexer = make_shared<LexicalAnalyzer>();
+                      auto code = make_shared<string>(generateSource(kb << 10, seed));
+                      counters.bytes = code->size();
+                      return [=]()
+                      {
+                          lexer->analyzeParallel(*code);
+                          keep(lexer->tokenBuffer().size());
+                      };
+                  });
+    }
+
+    // One keystroke typed and erased again at spread-out positions; the cost
+    // should not grow with the file.
+    for (int kb : {64, 16384})
+    {
+        suite.add("IncrementalLexer::edit", {{"kb", kb}}, [=](BenchCounters &counters)
+                  {
+                      auto lexer = make_shared<IncrementalLexer>();
+                      lexer->analyze(generateSource(size_t(kb) << 10, seed));
+                      auto position = make_shared<size_t>(0);
+                      counters.items = 2;
+                      return [=]()
+                      {
+                          *position = (*position + 7919) % lexer->textSize();
+                          lexer->edit(*position, 0, "x");
+                          keep(lexer->edit(*position, 1, "").relexedTokens);
+                      };
+                  });
+    }
+
+    // Scanner-shaped loop alternating whitespace runs and identifier runs.
+    vector<const CharClassKernels *> variants = {&CharClassKernels::scalar()};
+#ifdef CDLAB_X86
+    variants.push_back(&CharClassKernels::sse2());
+    if (__builtin_cpu_supports("avx2"))
+        variants.push_back(&CharClassKernels::avx2());
+#endif
+    for (const CharClassKernels *kernels : variants)
+    {
+        suite.add(string("CharClassKernels/") + kernels->name, {{"kb", 1024}}, [=](BenchCounters &counters)
+                  {
+                      auto text = make_shared<string>(generateSource(1 << 20, seed));
+                      counters.bytes = text->size();
+                      return [=]()
+                      {
+                          size_t i = 0, n = text->size(), runs = 0;
+                          while (i < n)
+                          {
+                              i = kernels->skipWhitespace(text->data(), i, n);
+                              size_t end = kernels->skipIdentifier(text->data(), i, n);
+                              runs++;
+                              i = end == i ? i + 1 : end;
+                          }
+                          keep(runs);
+                      };
+                  });
+    }
+
+    // Baseline for the kernels: the original 03 scanner, one isspace() and
+    // one isSpecialChar() test per byte, with the token vector replaced by a
+    // count.
+    suite.add("CharClassKernels/isspace-baseline", {{"kb", 1024}}, [=](BenchCounters &counters)
+              {
+                  auto text = make_shared<string>(generateSource(1 << 20, seed));
+                  counters.bytes = text->size();
+                  return [=]()
+                  {
+                      auto isSpecialChar = [](char c)
+                      {
+                          string specialChars = "+-*/=<>(){}[];,";
+                          return specialChars.find(c) != string::npos;
+                      };
+                      string currentToken;
+                      size_t tokens = 0;
+                      for (char c : *text)
+                      {
+                          if (isspace(c) || isSpecialChar(c))
+                          {
+                              if (!currentToken.empty())
+                              {
+                                  tokens++;
+                                  currentToken.clear();
+                              }
+                              tokens += !isspace(c);
+                              continue;
+                          }
+                          currentToken += c;
+                      }
+                      keep(tokens + !currentToken.empty());
+                  };
+              });
+
+    // Bulk vocabulary scan: tokenize and look every token up, against one
+    // Aho-Corasick pass over the raw text.
+    for (auto mode : {AhoCorasick::OVERLAPPING, AhoCorasick::LEFTMOST_LONGEST})
+    {
+        suite.add(mode == AhoCorasick::OVERLAPPING ? "AhoCorasick::scan/overlapping" : "AhoCorasick::scan/leftmost-longest",
+                  {{"kb", 1024}}, [=](BenchCounters &counters)
+                  {
+                      auto code = make_shared<string>(generateSource(1 << 20, seed));
+                      counters.bytes = code->size();
+                      return [=]()
+                      {
+                          size_t found = 0;
+                          TokenAnalyzer::vocabularyMatcher().scan(*code, [&](size_t, uint32_t pattern) { found += pattern; }, mode);
+                          keep(found);
+                      };
+                  });
+    }
+    suite.add("vocabulary/tokenize+lookup", {{"kb", 1024}}, [](BenchCounters &counters)
+              {
+                  auto analyzer = make_shared<TokenAnalyzer>();
+                  auto code = make_shared<string>(generateSource(1 << 20, seed));
+                  counters.bytes = code->size();
+                  return [=]()
+                  {
+                      analyzer->tokenize(*code);
+                      const TokenBuffer &tokens = analyzer->tokenBuffer();
+                      size_t found = 0;
+                      for (size_t i = 0; i < tokens.size(); i++)
+                      {
+                          string_view token = analyzer->symbolTable().name(tokens.symbols[i]);
+                          found += TokenAnalyzer::keywords.contains(token) || TokenAnalyzer::operators.contains(token);
+                      }
+                      keep(found);
+                  };
+              });
+
+    // Vocabulary lookups: the compile-time perfect hash against the
+    // unordered_set<string> lookups it replaced.
+    auto vocabularySample = []()
+    {
+        auto sample = make_shared<vector<string>>();
+        const char *others[] = {"x", "counter", "value_2", "10", "main_loop", "[", "\"s\""};
+        for (int i = 0; i < 4096; i++)
+        {
+            switch (i % 4)
+            {
+            case 0:
+                sample->emplace_back(TokenAnalyzer::keywordList[i % size(TokenAnalyzer::keywordList)]);
+                break;
+            case 1:
+                sample->emplace_back(TokenAnalyzer::operatorList[i % size(TokenAnalyzer::operatorList)]);
+                break;
+            case 2:
+                sample->emplace_back(TokenAnalyzer::punctuationList[i % size(TokenAnalyzer::punctuationList)]);
+                break;
+            default:
+                sample->push_back(others[i % 7]);
+            }
+        }
+        return sample;
+    };
+    suite.add("vocabulary/unordered_set", {{"tokens", 4096}}, [=](BenchCounters &counters)
+              {
+                  auto sample = vocabularySample();
+                  auto sets = make_shared<vector<unordered_set<string>>>(3);
+                  for (string_view word : TokenAnalyzer::keywordList)
+                      (*sets)[0].insert(string(word));
+                  for (string_view word : TokenAnalyzer::operatorList)
+                      (*sets)[1].insert(string(word));
+                  for (string_view word : TokenAnalyzer::punctuationList)
+                      (*sets)[2].insert(string(word));
+                  counters.items = sample->size();
+                  return [=]()
+                  {
+                      int found = 0;
+                      for (const string &token : *sample)
+                          found += (*sets)[0].count(token) ? 1 : (*sets)[1].count(token) ? 2 : (*sets)[2].count(token) ? 3 : 0;
+                      keep(found);
+                  };
+              });
+    suite.add("vocabulary/perfect_hash", {{"tokens", 4096}}, [=](BenchCounters &counters)
+              {
+                  auto sample = vocabularySample();
+                  counters.items = sample->size();
+                  return [=]()
+                  {
+                      int found = 0;
+                      for (const string &token : *sample)
+                      {
+                          string_view view = token;
+                          found += TokenAnalyzer::keywords.contains(view) ? 1 : TokenAnalyzer::operators.contains(view) ? 2 : TokenAnalyzer::punctuations.contains(view) ? 3 : 0;
+                      }
+                      keep(found);
+                  };
+              });
+}
+
+void addParserBenchmarks(BenchSuite &suite)
+{
+    for (int operands : {1000, 100000})
+    {
+        suite.add("RecursiveDescentParser::parse", {{"operands", operands}}, [=](BenchCounters &counters)
+                  {
+                      auto parser = make_shared<RecursiveDescentParser>();
+                      auto expr = make_shared<string>(generateExpression(operands, 32, seed));
+                      counters.bytes = expr->size();
+                      return [=]() { keep(parser->parse(*expr)); };
+                  });
+    }
+    suite.add("RecursiveDescentParser::parse/nested", {{"depth", 10000}}, [](BenchCounters &counters)
+              {
+                  auto parser = make_shared<RecursiveDescentParser>();
+                  auto expr = make_shared<string>(generateNestedExpression(10000));
+                  counters.bytes = expr->size();
+                  return [=]() { keep(parser->parse(*expr)); };
+              });
+
+    for (int operands : {1000, 100000})
+    {
+        suite.add("PrattParser::parse", {{"operands", operands}}, [=](BenchCounters &counters)
+                  {
+                      auto parser = make_shared<PrattParser>();
+                      auto tree = make_shared<ExpressionTree>();
+                      auto expr = make_shared<string>(generateExpression(operands, 32, seed));
+                      counters.bytes = expr->size();
+                      return [=]() { keep(parser->parse(*expr, *tree)); };
+                  });
+    }
+    for (int depth : {10000, 1000000})
+    {
+        suite.add("PrattParser::parse/nested", {{"depth", depth}}, [=](BenchCounters &counters)
+                  {
+                      auto parser = make_shared<PrattParser>();
+                      auto tree = make_shared<ExpressionTree>();
+                      auto expr = make_shared<string>(generateNestedExpression(depth));
+                      counters.bytes = expr->size();
+                      return [=]() { keep(parser->parse(*expr, *tree)); };
+                  });
+    }
+    suite.add("ExpressionTree::evaluate", {{"operands", 100000}}, [](BenchCounters &counters)
+              {
+                  PrattParser parser;
+                  auto tree = make_shared<ExpressionTree>();
+                  parser.parse(generateExpression(100000, 32, seed), *tree);
+                  counters.items = tree->nodes.size();
+                  return [=]()
+                  {
+                      long long value = 0;
+                      tree->evaluate({}, value);
+                      keep(value);
+                  };
+              });
+    for (unsigned threads : {1u, thread::hardware_concurrency()})
+    {
+        suite.add("BatchValidator::validate", {{"lines", 100000}, {"threads", threads}}, [=](BenchCounters &counters)
+                  {
+                      auto text = make_shared<string>(generateExpressionLines(100000, seed));
+                      counters.bytes = text->size();
+                      counters.items = 100000;
+                      return [=]()
+                      {
+                          istringstream in(*text);
+                          size_t invalid = 0;
+                          BatchValidator(threads, BatchValidator::PRATT).validate(in, [&](size_t, BatchValidator::LineResult result) { invalid += !result.valid; });
+                          keep(invalid);
+                      };
+                  });
+    }
+}
+
+void addGrammarBenchmarks(BenchSuite &suite)
+{
+    for (int nonTerminalCount : {8, 26})
+    {
+        suite.add("computeFirst+computeFollow", {{"nonterminals", nonTerminalCount}, {"alternatives", 8}},
+                  [=](BenchCounters &counters)
+                  {
+                      auto generated = generateGrammar(nonTerminalCount, 8, 6, seed, false);
+                      grammar.clear();
+                      nonTerminals.clear();
+                      terminals.clear();
+                      for (const auto &rule : generated)
+                      {
+                          nonTerminals.insert(rule.first[0]);
+                          grammar[rule.first[0]] = rule.second;
+                      }
+                      for (const auto &rule : generated)
+                          for (const string &production : rule.second)
+                              for (char c : production)
+                                  if (!nonTerminals.count(c))
+                                      terminals.insert(c);
+                      startSymbol = 'A';
+                      counters.items = nonTerminalCount;
+                      return []()
+                      {
+                          firsts.clear();
+                          follows.clear();
+                          for (char nt : nonTerminals)
+                              computeFirst(nt);
+                          for (char nt : nonTerminals)
+                              computeFollow(nt);
+                          keep(firsts.size() + follows.size());
+                      };
+                  });
+    }
+
+    for (int nonTerminalCount : {100, 1000})
+    {
+        suite.add("computeFirstFollowSets", {{"nonterminals", nonTerminalCount}, {"alternatives", 10}},
+                  [=](BenchCounters &counters)
+                  {
+                      auto interned = make_shared<Grammar>(Grammar::fromRules(generateGrammar(nonTerminalCount, 10, 6, seed)));
+                      counters.items = interned->productions.size();
+                      return [=]() { keep(computeFirstFollowSets(*interned).first.size()); };
+                  });
+    }
+
+    suite.add("predictiveParse", {{"operands", 100000}}, [](BenchCounters &counters)
+              {
+                  // E/T/F expression grammar in LL(1) form; X and Y are E' and T'.
+                  auto interned = make_shared<Grammar>(Grammar::fromRules(
+                      {{"E", {"TX"}}, {"X", {"+TX", "ε"}}, {"T", {"FY"}}, {"Y", {"*FY", "ε"}}, {"F", {"(E)", "i"}}}, "E"));
+                  auto table = make_shared<LL1Table>(buildLL1Table(*interned, computeFirstFollowSets(*interned)));
+                  auto tokens = make_shared<vector<uint32_t>>();
+                  for (char c : generateExpression(100000, 32, seed))
+                      tokens->push_back(interned->find(isdigit((unsigned char)c) ? "i" : string(1, c)));
+                  counters.items = tokens->size();
+                  return [=]() { keep(predictiveParse(*interned, *table, *tokens)); };
+              });
+
+    for (auto [levels, operators] : {pair<int, int>{50, 4}, pair<int, int>{200, 5}})
+    {
+        suite.add("buildLALRTable", {{"levels", levels}, {"operators", operators}}, [=](BenchCounters &counters)
+                  {
+                      auto interned = make_shared<Grammar>(Grammar::fromRules(generateOperatorGrammar(levels, operators), "E0"));
+                      auto sets = make_shared<FirstFollowSets>(computeFirstFollowSets(*interned));
+                      counters.items = interned->productions.size();
+                      return [=]() { keep(buildLALRTable(*interned, *sets).stateCount); };
+                  });
+    }
+
+    suite.add("lalrParse", {{"operands", 100000}}, [](BenchCounters &counters)
+              {
+                  auto interned = make_shared<Grammar>(
+                      Grammar::fromRules({{"E", {"E+T", "T"}}, {"T", {"T*F", "F"}}, {"F", {"(E)", "i"}}}, "E"));
+                  auto table = make_shared<LALRTable>(buildLALRTable(*interned, computeFirstFollowSets(*interned)));
+                  auto tokens = make_shared<vector<uint32_t>>();
+                  for (char c : generateExpression(100000, 32, seed))
+                      tokens->push_back(interned->find(isdigit((unsigned char)c) ? "i" : string(1, c)));
+                  counters.items = tokens->size();
+                  return [=]() { keep(lalrParse(*interned, *table, *tokens)); };
+              });
+
+    for (int nonTerminalCount : {26, 500})
+    {
+        suite.add("leftFactorGrammar", {{"nonterminals", nonTerminalCount}, {"alternatives", 8}}, [=](BenchCounters &counters)
+                  {
+                      auto generated = make_shared<map<string, vector<string>>>(generateGrammar(nonTerminalCount, 8, 6, seed));
+                      counters.items = nonTerminalCount;
+                      return [=]()
+                      {
+                          MuteCout mute;
+                          leftFactorGrammar(*generated);
+                      };
+                  });
+        suite.add("leftFactor", {{"nonterminals", nonTerminalCount}, {"alternatives", 200}}, [=](BenchCounters &counters)
+                  {
+                      auto interned = make_shared<Grammar>(Grammar::fromRules(generateGrammar(nonTerminalCount, 200, 6, seed)));
+                      counters.items = interned->productions.size();
+                      return [=]() { keep(leftFactor(*interned).productions.size()); };
+                  });
+        suite.add("removeLeftRecursion", {{"nonterminals", nonTerminalCount}, {"alternatives", 8}}, [=](BenchCounters &counters)
+                  {
+                      auto generated = make_shared<map<string, vector<string>>>(generateGrammar(nonTerminalCount, 8, 6, seed));
+                      counters.items = nonTerminalCount;
+                      return [=]()
+                      {
+                          MuteCout mute;
+                          for (auto &rule : *generated)
+                              removeLeftRecursion(rule.first, rule.second);
+                      };
+                  });
+        suite.add("eliminateLeftRecursion", {{"nonterminals", nonTerminalCount * 4}, {"alternatives", 8}},
+                  [=](BenchCounters &counters)
+                  {
+                      auto interned = make_shared<Grammar>(Grammar::fromRules(generateGrammar(nonTerminalCount * 4, 8, 6, seed)));
+                      counters.items = interned->productions.size();
+                      return [=]() { keep(eliminateLeftRecursion(*interned).productions.size()); };
+                  });
+    }
+}
+
+// The recording and export paths themselves; whether the library's hot
+// loops call them depends on CDLAB_METRICS.
+void addMetricsBenchmarks(BenchSuite &suite)
+{
+    suite.add("Metrics::add", {{"events", 4096}}, [](BenchCounters &counters)
+              {
+                  counters.items = 4096;
+                  return []()
+                  {
+                      for (int i = 0; i < 4096; i++)
+                          Metrics::add(Metric::DFA_BYTES, i);
+                  };
+              });
+    suite.add("Metrics::writePrometheus", {{"metrics", int(Metric::COUNT)}}, [](BenchCounters &counters)
+              {
+                  counters.items = int(Metric::COUNT);
+                  return []()
+                  {
+                      ostringstream out;
+                      Metrics::writePrometheus(out);
+                      keep(out.str().size());
+                  };
+              });
+}
+
+int main(int argc, char **argv)
+{
+    BenchSuite suite;
+    addAutomataBenchmarks(suite);
+    addLexerBenchmarks(suite);
+    addParserBenchmarks(suite);
+    addGrammarBenchmarks(suite);
+    addMetricsBenchmarks(suite);
+    return suite.main(argc, argv);
+}
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <cstdint>
+#include "nfa.h"
+#include "dfa.h"
+
+// Deterministic synthetic inputs for the benchmarks. Everything is derived
+// from an explicit seed through splitmix64, so a given (size, seed) pair
+// produces the same bytes on every platform and standard library.
+class CorpusRng
+{
+    uint64_t state;
+
+public:
+    explicit CorpusRng(uint64_t seed) : state(seed) {}
+
+    uint64_t next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, bound).
+    uint64_t below(uint64_t bound) { return next() % bound; }
+    bool chance(int percent) { return below(100) < (uint64_t)percent; }
+};
+
+// C-like source in the shape both lexers expect: declarations, conditionals,
+// arithmetic, string literals and // comments, roughly `bytes` long.
+inline std::string generateSource(size_t bytes, uint64_t seed)
+{
+    CorpusRng rng(seed);
+    const char *types[] = {"int", "float", "char", "double"};
+    const char *names[] = {"x", "count", "total_sum", "i", "value2", "buffer_len", "result", "tmp"};
+    const char *ops[] = {"+", "-", "*", "/", "==", "<=", ">=", "!="};
+    std::string out;
+    int depth = 0;
+    while (out.size() < bytes)
+    {
+        std::string indent(4 * depth + 4, ' ');
+        switch (rng.below(6))
+        {
+        case 0:
+            out += indent + types[rng.below(4)] + " " + names[rng.below(8)] + " = " + std::to_string(rng.below(100000)) + ";\n";
+            break;
+        case 1:
+            out += indent + names[rng.below(8)] + " = " + names[rng.below(8)] + " " + ops[rng.below(8)] + " " +
+                   std::to_string(rng.below(1000)) + ";\n";
+            break;
+        case 2:
+            if (depth < 6)
+            {
+                out += indent + "if ( " + names[rng.below(8)] + " > " + std::to_string(rng.below(50)) + " ) {\n";
+                depth++;
+            }
+            break;
+        case 3:
+            if (depth > 0)
+            {
+                depth--;
+                out += std::string(4 * depth + 4, ' ') + "}\n";
+            }
+            break;
+        case 4:
+            out += indent + "// " + names[rng.below(8)] + " holds the running value\n";
+            break;
+        default:
+            out += indent + "return \"" + names[rng.below(8)] + "\" ;\n";
+        }
+    }
+    while (depth-- > 0)
+        out += std::string(4 * depth + 4, ' ') + "}\n";
+    return out;
+}
+
+// Expression for the E/T/F grammar of RecursiveDescentParser: single-digit
+// operands, + and *, parentheses nested up to maxDepth.
+inline std::string generateExpression(size_t operands, int maxDepth, uint64_t seed)
+{
+    CorpusRng rng(seed);
+    std::string out;
+    int depth = 0;
+    for (size_t i = 0; i < operands; i++)
+    {
+        if (i > 0)
+            out += rng.chance(50) ? '+' : '*';
+        while (depth < maxDepth && rng.chance(30))
+        {
+            out += '(';
+            depth++;
+        }
+        out += char('0' + rng.below(10));
+        while (depth > 0 && rng.chance(30))
+        {
+            out += ')';
+            depth--;
+        }
+    }
+    out.append(depth, ')');
+    return out;
+}
+
+// `lines` independent expressions, one per line, about one in ten of them
+// corrupted so batch validation sees both outcomes.
+inline std::string generateExpressionLines(size_t lines, uint64_t seed)
+{
+    CorpusRng rng(seed);
+    std::string out;
+    for (size_t i = 0; i < lines; i++)
+    {
+        std::string expr = generateExpression(1 + rng.below(40), 8, rng.next());
+        if (rng.chance(10))
+            expr[rng.below(expr.size())] = ')';
+        out += expr + "\n";
+    }
+    return out;
+}
+
+// Expression nested `depth` parentheses deep around a single operand.
+inline std::string generateNestedExpression(int depth)
+{
+    return std::string(depth, '(') + "1" + std::string(depth, ')');
+}
+
+// Union of `patterns` random literal words over a-z, the shape of a token
+// vocabulary compiled into one automaton. With useEpsilon the start state
+// reaches each word through an epsilon edge, otherwise words hang directly
+// off the start state.
+inline IndexedNFA generatePatternUnionNFA(int patterns, int maxLength, uint64_t seed, bool useEpsilon = true)
+{
+    CorpusRng rng(seed);
+    IndexedNFA nfa;
+    nfa.startState = nfa.addState();
+    for (int p = 0; p < patterns; p++)
+    {
+        int length = 1 + rng.below(maxLength);
+        int state = nfa.startState;
+        if (useEpsilon)
+        {
+            int entry = nfa.addState();
+            nfa.addEpsilonTransition(state, entry);
+            state = entry;
+        }
+        for (int i = 0; i < length; i++)
+        {
+            int next = nfa.addState(i == length - 1);
+            nfa.addTransition(state, char('a' + rng.below(26)), next);
+            state = next;
+        }
+    }
+    return nfa;
+}
+
+// NFA for (a|b)*a(a|b)^(k-1); its DFA has 2^k states.
+inline IndexedNFA generateSuffixNFA(int k)
+{
+    IndexedNFA nfa;
+    for (int i = 0; i <= k; i++)
+        nfa.addState(i == k);
+    nfa.addTransition(0, 'a', 0);
+    nfa.addTransition(0, 'b', 0);
+    nfa.addTransition(0, 'a', 1);
+    for (int i = 1; i < k; i++)
+    {
+        nfa.addTransition(i, 'a', i + 1);
+        nfa.addTransition(i, 'b', i + 1);
+    }
+    return nfa;
+}
+
+// Same automaton in the map-based NFA used by the set-keyed construction.
+inline NFA toMapNFA(const IndexedNFA &indexed, std::set<int> &states, std::set<char> &alphabet)
+{
+    NFA nfa;
+    nfa.startState = indexed.startState;
+    for (int s = 0; s < indexed.stateCount(); s++)
+    {
+        states.insert(s);
+        if (indexed.accepting[s])
+            nfa.acceptStates.insert(s);
+        for (const auto &edge : indexed.edges[s])
+        {
+            nfa.addTransition(s, edge.first, edge.second);
+            alphabet.insert(edge.first);
+        }
+    }
+    return nfa;
+}
+
+// Complete random DFA over the first `alphabetSize` lowercase letters.
+inline DFA generateDFA(int states, int alphabetSize, uint64_t seed)
+{
+    CorpusRng rng(seed);
+    DFA dfa;
+    dfa.setStartState(0);
+    for (int s = 0; s < states; s++)
+    {
+        if (rng.chance(30))
+            dfa.addAcceptState(s);
+        for (int c = 0; c < alphabetSize; c++)
+            dfa.addTransition(s, char('a' + c), rng.below(states));
+    }
+    return dfa;
+}
+
+inline std::string generateDFAInput(size_t length, int alphabetSize, uint64_t seed)
+{
+    CorpusRng rng(seed);
+    std::string out(length, 'a');
+    for (char &c : out)
+        c = char('a' + rng.below(alphabetSize));
+    return out;
+}
+
+// Left-recursive precedence tower in the spaced grammar format: level i is
+// E<i> -> E<i> op<i>_<k> E<i+1> | E<i+1> for each of `operators` operators, and
+// the last level is ( E0 ) | x. It is LALR(1) and its automaton grows with
+// levels * operators, which makes it a realistic generator workload.
+inline std::map<std::string, std::vector<std::string>> generateOperatorGrammar(int levels, int operators)
+{
+    std::map<std::string, std::vector<std::string>> grammar;
+    for (int i = 0; i < levels; i++)
+    {
+        std::string level = "E" + std::to_string(i), next = "E" + std::to_string(i + 1);
+        for (int k = 0; k < operators; k++)
+            grammar[level].push_back(level + " op" + std::to_string(i) + "_" + std::to_string(k) + " " + next);
+        grammar[level].push_back(next);
+    }
+    grammar["E" + std::to_string(levels)] = {"( E0 )", "x"};
+    return grammar;
+}
+
+// Grammar with `nonTerminals` rules of `alternatives` productions each, as
+// symbol strings. Nonterminals are A..Z (or N0, N1, ... past 26), terminals
+// are lowercase letters. About a third of the alternatives share a prefix
+// with a sibling and, with leftRecursive, some are directly left-recursive,
+// so left factoring and left-recursion removal have work to do. Right-hand
+// sides only mention later nonterminals, so there are no other cycles.
+inline std::map<std::string, std::vector<std::string>> generateGrammar(int nonTerminals, int alternatives, int maxLength, uint64_t seed,
+                                                   bool leftRecursive = true)
+{
+    CorpusRng rng(seed);
+    std::vector<std::string> names;
+    for (int i = 0; i < nonTerminals; i++)
+        names.push_back(nonTerminals <= 26 ? std::string(1, char('A' + i)) : "N" + std::to_string(i));
+
+    std::map<std::string, std::vector<std::string>> grammar;
+    for (int n = 0; n < nonTerminals; n++)
+    {
+        std::vector<std::string> &productions = grammar[names[n]];
+        std::vector<std::vector<std::string>> symbols; // productions split into symbols, for prefix sharing
+        for (int a = 0; a < alternatives; a++)
+        {
+            std::vector<std::string> production;
+            std::string text;
+            if (a > 0 && rng.chance(30))
+            {
+                const std::vector<std::string> &sibling = symbols[rng.below(symbols.size())];
+                production.assign(sibling.begin(), sibling.begin() + std::min<size_t>(2, sibling.size()));
+            }
+            else if (leftRecursive && rng.chance(15))
+                production.push_back(names[n]);
+            for (const std::string &symbol : production)
+                text += symbol;
+            int length = 1 + rng.below(maxLength);
+            while ((int)text.size() < length)
+            {
+                if (rng.chance(25) && n + 1 < nonTerminals)
+                    production.push_back(names[n + 1 + rng.below(nonTerminals - n - 1)]);
+                else
+                    production.push_back(std::string(1, char('a' + rng.below(26))));
+                text += production.back();
+            }
+            symbols.push_back(production);
+            productions.push_back(text);
+        }
+    }
+    return grammar;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// The original char-based FIRST/FOLLOW over mutable globals, kept only as the
+// computeFirst+computeFollow baseline for computeFirstFollowSets (grammar.h).
+inline std::map<char, std::vector<std::string>> grammar; // Stores grammar rules
+inline std::map<char, std::set<char>> firsts, follows; // FIRST and FOLLOW sets
+inline std::set<char> nonTerminals, terminals;
+inline char startSymbol;
+inline const char epsilonSymbol = '\xB5'; // Stands for ε in the char sets (last byte of its UTF-8 form)
+
+// Function to compute FIRST set
+inline void computeFirst(char symbol) {
+    if (firsts[symbol].size() > 0) return; // Already computed
+
+    for (std::string production : grammar[symbol]) {
+        char firstChar = production[0];
+
+        if (terminals.count(firstChar)) {
+            firsts[symbol].insert(firstChar); // If terminal, add directly
+        } else if (nonTerminals.count(firstChar)) {
+            computeFirst(firstChar);
+            firsts[symbol].insert(firsts[firstChar].begin(), firsts[firstChar].end()); // Copy FIRST of non-terminal
+        }
+
+        if (production == "ε") {
+            firsts[symbol].insert(epsilonSymbol); // If epsilon production
+        }
+    }
+}
+
+// Function to compute FOLLOW set
+inline void computeFollow(char symbol) {
+    if (follows[symbol].size() > 0) return; // Already computed
+
+    if (symbol == startSymbol) {
+        follows[symbol].insert('$'); // FOLLOW(start) = { $ }
+    }
+
+    for (auto rule : grammar) {
+        for (std::string production : rule.second) {
+            for (size_t i = 0; i < production.length(); i++) {
+                if (production[i] == symbol) { // If symbol found in production
+                    if (i + 1 < production.length()) {
+                        char nextChar = production[i + 1];
+                        if (terminals.count(nextChar)) {
+                            follows[symbol].insert(nextChar);
+                        } else if (nonTerminals.count(nextChar)) {
+                            follows[symbol].insert(firsts[nextChar].begin(), firsts[nextChar].end());
+                            follows[symbol].erase(epsilonSymbol); // Remove epsilon
+                        }
+                    } else {
+                        follows[symbol].insert(follows[rule.first].begin(), follows[rule.first].end());
+                    }
+                }
+            }
+        }
+    }
+}
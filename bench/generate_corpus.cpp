@@ -0,0 +1,82 @@
+#include <iostream>
+#include <string>
+#include "corpus.h"
+
+using namespace std;
+
+// Writes one synthetic input to stdout:
+//   source <bytes>          C-like source for 03/04
+//   expression <operands>   one expression for 05
+//   expressions <lines>     one expression per line for 05 --batch
+//   nfa <patterns>          pattern-union NFA as "from symbol to" lines
+//   dfa <states>            random DFA over a-d as "from symbol to" lines
+//   grammar <nonterminals>  grammar in the input format of 06
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        cerr << "Usage: " << argv[0] << " source|expression|expressions|nfa|dfa|grammar <size> [seed]\n";
+        return 1;
+    }
+    string kind = argv[1];
+    long long size = stoll(argv[2]);
+    uint64_t seed = argc > 3 ? stoull(argv[3]) : 42;
+
+    if (kind == "source")
+    {
+        cout << generateSource(size, seed);
+    }
+    else if (kind == "expression")
+    {
+        cout << generateExpression(size, 32, seed) << "\n";
+    }
+    else if (kind == "expressions")
+    {
+        cout << generateExpressionLines(size, seed);
+    }
+    else if (kind == "nfa")
+    {
+        IndexedNFA nfa = generatePatternUnionNFA(size, 8, seed);
+        cout << "states " << nfa.stateCount() << " start " << nfa.startState << "\naccept";
+        for (int s = 0; s < nfa.stateCount(); s++)
+            if (nfa.accepting[s])
+                cout << " " << s;
+        cout << "\n";
+        for (int s = 0; s < nfa.stateCount(); s++)
+        {
+            for (int to : nfa.epsilon[s])
+                cout << s << " eps " << to << "\n";
+            for (const auto &edge : nfa.edges[s])
+                cout << s << " " << edge.first << " " << edge.second << "\n";
+        }
+    }
+    else if (kind == "dfa")
+    {
+        DFA dfa = generateDFA(size, 4, seed);
+        cout << "states " << size << " start " << dfa.startState() << "\naccept";
+        for (int s : dfa.acceptStates())
+            cout << " " << s;
+        cout << "\n";
+        for (const auto &row : dfa.transitions())
+            for (const auto &edge : row.second)
+                cout << row.first << " " << edge.first << " " << edge.second << "\n";
+    }
+    else if (kind == "grammar")
+    {
+        auto grammar = generateGrammar(size, 8, 6, seed);
+        cout << grammar.size() << "\n";
+        for (const auto &rule : grammar)
+        {
+            cout << rule.first << " ->";
+            for (size_t i = 0; i < rule.second.size(); i++)
+                cout << (i ? " | " : " ") << rule.second[i];
+            cout << "\n";
+        }
+    }
+    else
+    {
+        cerr << "Unknown corpus kind: " << kind << "\n";
+        return 1;
+    }
+    return 0;
+}
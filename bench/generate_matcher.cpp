@@ -0,0 +1,53 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "matcher_codegen.h"
+
+using namespace std;
+
+// Reads a DFA in the format `generate_corpus dfa` writes and writes a matcher
+// header for it:
+//   generate_matcher <dfa file> <function name> switch|table <output header>
+int main(int argc, char **argv)
+{
+    if (argc != 5 || (string(argv[3]) != "switch" && string(argv[3]) != "table"))
+    {
+        cerr << "Usage: " << argv[0] << " <dfa file> <function name> switch|table <output header>\n";
+        return 1;
+    }
+
+    ifstream in(argv[1]);
+    string word, line;
+    int states = 0, start = 0;
+    DFA dfa;
+    if (!(in >> word >> states >> word >> start >> word) || word != "accept")
+    {
+        cerr << "Malformed DFA header in " << argv[1] << "\n";
+        return 1;
+    }
+    dfa.setStartState(start);
+    getline(in, line);
+    istringstream accepting(line);
+    for (int state; accepting >> state;)
+        dfa.addAcceptState(state);
+    int from, to;
+    char symbol;
+    while (in >> from >> symbol >> to)
+        dfa.addTransition(from, symbol, to);
+    if (!in.eof())
+    {
+        cerr << "Malformed transition in " << argv[1] << "\n";
+        return 1;
+    }
+    dfa.compile();
+
+    ofstream out(argv[4], ios::binary);
+    writeMatcher(dfa.compiledForm(), argv[2], string(argv[3]) == "switch" ? MatcherStyle::SWITCH : MatcherStyle::TABLE, out);
+    if (!out)
+    {
+        cerr << "Cannot write " << argv[4] << "\n";
+        return 1;
+    }
+    return 0;
+}
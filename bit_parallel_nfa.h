@@ -0,0 +1,266 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <cstdint>
+#include <string_view>
+#include "platform.h"
+#include "nfa.h"
+
+// Matches against an IndexedNFA with the set of active states packed into
+// machine words, so nothing is determinized and the cost per byte does not
+// depend on how large the equivalent DFA would be.
+//
+// The NFA is first put in Glushkov form: one position per (target state,
+// symbol) edge label reachable from the start, with epsilon edges folded in,
+// so every edge into a position carries the same symbol. A step is then
+//
+//     active = follow(active) & symbolMask[byte]
+//
+// where follow() ORs precomputed rows, one per 8-position chunk of the
+// active set. Up to 64 and 128 positions the set is one or two uint64_t and
+// every chunk is looked up. Up to 256 it is one AVX2 register (four words
+// without AVX2) and only non-zero chunks are looked up, since a fixed 32
+// lookups would mostly fetch empty rows. Larger NFAs still work, folding in
+// one follow row per active position.
+class BitParallelNFA
+{
+public:
+    explicit BitParallelNFA(const IndexedNFA &nfa)
+    {
+        // Position 0 stands for the start state's closure
+        std::vector<int> target = {nfa.startState};
+        std::vector<unsigned char> symbol = {0};
+        std::vector<std::vector<int>> follows;
+        std::vector<bool> accepting;
+        if (nfa.stateCount() > 0)
+        {
+            EpsilonClosure closure(nfa);
+            std::unordered_map<long long, int> positionOf; // target * 256 + symbol
+            for (size_t p = 0; p < target.size(); p++)
+            {
+                std::vector<int> out;
+                bool accepts = false;
+                closure.of(target[p]).forEach([&](int state)
+                {
+                    accepts |= nfa.accepting[state];
+                    for (const auto &edge : nfa.edges[state])
+                    {
+                        unsigned char c = edge.first;
+                        auto [it, inserted] = positionOf.try_emplace((long long)edge.second * 256 + c, target.size());
+                        if (inserted)
+                        {
+                            target.push_back(edge.second);
+                            symbol.push_back(c);
+                        }
+                        out.push_back(it->second);
+                    }
+                });
+                follows.push_back(std::move(out));
+                accepting.push_back(accepts);
+            }
+        }
+        else
+        {
+            follows.emplace_back();
+            accepting.push_back(false);
+        }
+
+        positions = target.size();
+        words = positions <= 64 ? 1 : positions <= 128 ? 2 : positions <= 256 ? 4 : (positions + 63) / 64;
+        auto setBit = [&](uint64_t *row, int p) { row[p >> 6] |= uint64_t(1) << (p & 63); };
+
+        symbolMask.assign(256 * words, 0);
+        acceptMask.assign(words, 0);
+        follow.assign(positions * words, 0);
+        for (int p = 0; p < positions; p++)
+        {
+            if (p > 0)
+                setBit(&symbolMask[symbol[p] * words], p);
+            if (accepting[p])
+                setBit(acceptMask.data(), p);
+            for (int q : follows[p])
+                setBit(&follow[p * words], q);
+        }
+
+        // Row (chunk k, byte v) is the union of the follow rows of the
+        // positions 8k + i for the bits i set in v
+        if (words <= 4)
+        {
+            followTable.assign(words * 8 * 256 * words, 0);
+            for (int k = 0; k < words * 8; k++)
+            {
+                for (int v = 1; v < 256; v++)
+                {
+                    uint64_t *row = &followTable[(k * 256 + v) * words];
+                    const uint64_t *rest = &followTable[(k * 256 + (v & (v - 1))) * words];
+                    int p = k * 8 + __builtin_ctz(v);
+                    for (int w = 0; w < words; w++)
+                        row[w] = rest[w] | (p < positions ? follow[p * words + w] : 0);
+                }
+            }
+        }
+#ifdef CDLAB_X86
+        useAVX2 = words == 4 && __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    int positionCount() const { return positions; }
+
+    const char *kernelName() const
+    {
+        return words == 1 ? "64-bit" : words == 2 ? "128-bit" : words == 4 ? (useAVX2 ? "256-bit avx2" : "256-bit")
+                                                                           : "word array";
+    }
+
+    bool isAccepted(std::string_view input) const
+    {
+        switch (words)
+        {
+        case 1:
+            return matchDense<1>(input);
+        case 2:
+            return matchDense<2>(input);
+        case 4:
+#ifdef CDLAB_X86
+            if (useAVX2)
+                return matchAVX2(input);
+#endif
+            return matchSparse<4>(input);
+        default:
+            return matchLarge(input);
+        }
+    }
+
+private:
+    int positions = 1;
+    int words = 1;
+    bool useAVX2 = false;
+    std::vector<uint64_t> symbolMask;  // 256 x words: positions entered on the byte
+    std::vector<uint64_t> acceptMask;  // words
+    std::vector<uint64_t> follow;      // positions x words
+    std::vector<uint64_t> followTable; // (words * 8 chunks) x 256 x words, for up to 4 words
+
+    template <int W>
+    bool matchDense(std::string_view input) const
+    {
+        const uint64_t *table = followTable.data();
+        const uint64_t *masks = symbolMask.data();
+        std::array<uint64_t, W> active{}, next;
+        active[0] = 1;
+        for (unsigned char c : input)
+        {
+            next.fill(0);
+            for (int k = 0; k < 8 * W; k++)
+            {
+                const uint64_t *row = table + (k * 256 + ((active[k >> 3] >> (k & 7) * 8) & 255)) * W;
+                for (int w = 0; w < W; w++)
+                    next[w] |= row[w];
+            }
+            uint64_t any = 0;
+            for (int w = 0; w < W; w++)
+            {
+                active[w] = next[w] & masks[c * W + w];
+                any |= active[w];
+            }
+            if (!any)
+                return false;
+        }
+        return accepts(active.data());
+    }
+
+    template <int W>
+    bool matchSparse(std::string_view input) const
+    {
+        const uint64_t *table = followTable.data();
+        const uint64_t *masks = symbolMask.data();
+        std::array<uint64_t, W> active{}, next;
+        active[0] = 1;
+        for (unsigned char c : input)
+        {
+            next.fill(0);
+            for (int i = 0; i < W; i++)
+            {
+                for (uint64_t rest = active[i]; rest; rest &= ~(uint64_t(255) << (__builtin_ctzll(rest) & ~7)))
+                {
+                    int shift = __builtin_ctzll(rest) & ~7;
+                    const uint64_t *row = table + ((i * 8 + shift / 8) * 256 + ((rest >> shift) & 255)) * W;
+                    for (int w = 0; w < W; w++)
+                        next[w] |= row[w];
+                }
+            }
+            uint64_t any = 0;
+            for (int w = 0; w < W; w++)
+            {
+                active[w] = next[w] & masks[c * W + w];
+                any |= active[w];
+            }
+            if (!any)
+                return false;
+        }
+        return accepts(active.data());
+    }
+
+#ifdef CDLAB_X86
+    __attribute__((target("avx2"))) bool matchAVX2(std::string_view input) const
+    {
+        const uint64_t *table = followTable.data();
+        const uint64_t *masks = symbolMask.data();
+        alignas(32) uint8_t chunks[32];
+        __m256i active = _mm256_setr_epi64x(1, 0, 0, 0);
+        for (unsigned char c : input)
+        {
+            _mm256_store_si256((__m256i *)chunks, active);
+            uint32_t nonzero = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(active, _mm256_setzero_si256()));
+            __m256i next = _mm256_setzero_si256();
+            for (; nonzero; nonzero &= nonzero - 1)
+            {
+                int k = __builtin_ctz(nonzero);
+                next = _mm256_or_si256(next, _mm256_loadu_si256((const __m256i *)(table + (k * 256 + chunks[k]) * 4)));
+            }
+            active = _mm256_and_si256(next, _mm256_loadu_si256((const __m256i *)(masks + c * 4)));
+            if (_mm256_testz_si256(active, active))
+                return false;
+        }
+        return !_mm256_testz_si256(active, _mm256_loadu_si256((const __m256i *)acceptMask.data()));
+    }
+#endif
+
+    bool matchLarge(std::string_view input) const
+    {
+        std::vector<uint64_t> active(words, 0), next(words);
+        active[0] = 1;
+        for (unsigned char c : input)
+        {
+            std::fill(next.begin(), next.end(), 0);
+            for (int i = 0; i < words; i++)
+            {
+                for (uint64_t rest = active[i]; rest; rest &= rest - 1)
+                {
+                    const uint64_t *row = &follow[(i * 64 + __builtin_ctzll(rest)) * words];
+                    for (int w = 0; w < words; w++)
+                        next[w] |= row[w];
+                }
+            }
+            uint64_t any = 0;
+            for (int w = 0; w < words; w++)
+            {
+                active[w] = next[w] & symbolMask[c * words + w];
+                any |= active[w];
+            }
+            if (!any)
+                return false;
+        }
+        return accepts(active.data());
+    }
+
+    bool accepts(const uint64_t *active) const
+    {
+        uint64_t hit = 0;
+        for (int w = 0; w < words; w++)
+            hit |= active[w] & acceptMask[w];
+        return hit;
+    }
+};
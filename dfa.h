@@ -0,0 +1,207 @@
+#pragma once
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include "metrics.h"
+
+// Non-owning view of a compiled DFA's arrays, which may live in a
+// CompiledDFA or in a mapped file (see dfa_image.h).
+struct DFAView
+{
+    const uint8_t *byteClass = nullptr;
+    const int32_t *table = nullptr;
+    const uint64_t *acceptBits = nullptr;
+    int classCount = 1;
+    int stateCount = 1;
+    int startState = 0;
+
+    bool isAccepting(int state) const
+    {
+        return (acceptBits[state >> 6] >> (state & 63)) & 1;
+    }
+
+    bool matches(std::string_view input) const
+    {
+        const int32_t *rows = table;
+        const uint8_t *classes = byteClass;
+        const unsigned char *bytes = (const unsigned char *)input.data();
+        int currentState = startState;
+        CDLAB_COUNT(Metric::DFA_MATCHES, 1);
+        for (size_t i = 0; i < input.size(); i++)
+        {
+            currentState = rows[currentState * classCount + classes[bytes[i]]];
+            if (currentState == 0)
+            {
+                CDLAB_COUNT(Metric::DFA_BYTES, i + 1);
+                CDLAB_COUNT(Metric::DFA_DEAD_EXITS, 1);
+                return false;
+            }
+        }
+        CDLAB_COUNT(Metric::DFA_BYTES, input.size());
+        return isAccepting(currentState);
+    }
+};
+
+// Dense, immutable form of a DFA: one row per state, one column per byte class.
+// State 0 is the dead state; every other state is renumbered densely from 1.
+class CompiledDFA
+{
+public:
+    static constexpr int DEAD = 0;
+
+    std::array<uint8_t, 256> byteClass{}; // byte -> column in the transition table
+    int classCount = 1;
+    int stateCount = 1;
+    int startState = DEAD;
+    std::vector<int32_t> table;       // stateCount x classCount, row-major
+    std::vector<uint64_t> acceptBits; // bit i set if state i is accepting
+
+    bool isAccepting(int state) const
+    {
+        return (acceptBits[state >> 6] >> (state & 63)) & 1;
+    }
+
+    int step(int state, unsigned char symbol) const
+    {
+        return table[state * classCount + byteClass[symbol]];
+    }
+
+    DFAView view() const
+    {
+        return {byteClass.data(), table.data(), acceptBits.data(), classCount, stateCount, startState};
+    }
+
+    bool matches(std::string_view input) const
+    {
+        return view().matches(input);
+    }
+};
+
+class DFA
+{
+public:
+    void addTransition(int from, char symbol, int to)
+    {
+        edges[from][symbol] = to;
+        isCompiled = false;
+    }
+
+    void setStartState(int state)
+    {
+        start = state;
+        isCompiled = false;
+    }
+
+    void addAcceptState(int state)
+    {
+        accepting.insert(state);
+        isCompiled = false;
+    }
+
+    const std::map<int, std::map<char, int>> &transitions() const { return edges; }
+    int startState() const { return start; }
+    const std::set<int> &acceptStates() const { return accepting; }
+
+    // Builds the dense table used by isAccepted. Any later edit drops it
+    // until compile() is called again.
+    void compile()
+    {
+        std::unordered_map<int, int> dense; // original state -> dense id (0 is reserved for dead)
+        auto intern = [&](int state) { dense.try_emplace(state, dense.size() + 1); };
+        intern(start);
+        for (const auto &row : edges)
+        {
+            intern(row.first);
+            for (const auto &edge : row.second)
+                intern(edge.second);
+        }
+        for (int state : accepting)
+            intern(state);
+
+        int stateCount = dense.size() + 1;
+
+        // Split the byte partition one row at a time: two bytes stay in the
+        // same class only while every row seen so far sends them to the same
+        // state. A row only moves the bytes it has edges on, each to a fresh
+        // class per (class, target) pair; the rest keep their class, whose
+        // target is dead. Classes are renumbered by their lowest byte last.
+        std::array<int, 256> classOf{};
+        std::unordered_map<uint64_t, int> split; // (class, target) -> fresh class
+        int nextClass = 1;
+        for (const auto &row : edges)
+        {
+            split.clear();
+            for (const auto &edge : row.second)
+            {
+                unsigned char b = edge.first;
+                uint64_t key = uint64_t(classOf[b]) << 32 | uint32_t(dense[edge.second]);
+                auto [it, inserted] = split.try_emplace(key, nextClass);
+                nextClass += inserted;
+                classOf[b] = it->second;
+            }
+        }
+
+        compiled = CompiledDFA();
+        std::unordered_map<int, int> renumber;
+        for (int b = 0; b < 256; b++)
+            compiled.byteClass[b] = renumber.try_emplace(classOf[b], renumber.size()).first->second;
+        int classCount = renumber.size();
+
+        compiled.classCount = classCount;
+        compiled.stateCount = stateCount;
+        compiled.startState = dense[start];
+        compiled.table.assign(stateCount * classCount, CompiledDFA::DEAD);
+        for (const auto &row : edges)
+        {
+            int32_t *out = &compiled.table[dense[row.first] * classCount];
+            for (const auto &edge : row.second)
+                out[compiled.byteClass[(unsigned char)edge.first]] = dense[edge.second];
+        }
+
+        compiled.acceptBits.assign((stateCount + 63) / 64, 0);
+        for (int state : accepting)
+        {
+            int id = dense[state];
+            compiled.acceptBits[id >> 6] |= uint64_t(1) << (id & 63);
+        }
+        isCompiled = true;
+    }
+
+    const CompiledDFA &compiledForm() const { return compiled; }
+
+    bool isAccepted(std::string_view input) const
+    {
+        if (isCompiled)
+            return compiled.matches(input);
+
+        int currentState = start;
+        CDLAB_COUNT(Metric::DFA_MATCHES, 1);
+        for (size_t i = 0; i < input.size(); i++)
+        {
+            auto row = edges.find(currentState);
+            auto edge = row == edges.end() ? std::map<char, int>::const_iterator() : row->second.find(input[i]);
+            if (row == edges.end() || edge == row->second.end())
+            {
+                CDLAB_COUNT(Metric::DFA_BYTES, i + 1);
+                CDLAB_COUNT(Metric::DFA_DEAD_EXITS, 1);
+                return false; // Invalid transition, reject input
+            }
+            currentState = edge->second;
+        }
+        CDLAB_COUNT(Metric::DFA_BYTES, input.size());
+        return accepting.count(currentState);
+    }
+
+private:
+    std::map<int, std::map<char, int>> edges;
+    int start = 0;
+    std::set<int> accepting;
+    CompiledDFA compiled;
+    bool isCompiled = false;
+};
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "dfa.h"
+
+// Binary image of a CompiledDFA, laid out so that a mapping of the file can
+// be matched against directly. Every section starts on a 64-byte boundary:
+//
+//   header | byteClass (256 x uint8) | table (stateCount x classCount x int32)
+//          | acceptBits ((stateCount + 63) / 64 x uint64)
+//
+// Integers are in the writer's byte order, recorded by endianTag; a reader
+// with the other order rejects the file. The checksum covers the whole file,
+// with the header's checksum field read as zero.
+struct DFAImageHeader
+{
+    static constexpr char MAGIC[8] = {'C', 'D', 'L', 'D', 'F', 'A', '\r', '\n'}; // \r\n catches text-mode copies
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t ENDIAN_TAG = 0x01020304;
+    static constexpr size_t ALIGNMENT = 64;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t endianTag;
+    uint32_t stateCount;
+    uint32_t classCount;
+    int32_t startState;
+    uint32_t reserved;
+    uint64_t byteClassOffset;
+    uint64_t tableOffset;
+    uint64_t acceptOffset;
+    uint64_t fileSize;
+    uint64_t checksum;
+};
+
+// 64-bit checksum over whole words: a multiply-rotate mix that keeps up with
+// memory bandwidth, so verifying a large image costs little next to reading it.
+inline uint64_t dfaImageChecksum(const unsigned char *data, size_t size, uint64_t h = 0x9E3779B97F4A7C15ull)
+{
+    h ^= size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        h = (h ^ word) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    for (; i < size; i++)
+        h = (h ^ data[i]) * 0x100000001B3ull;
+    return h ^ (h >> 29);
+}
+
+// Checksum of a whole image: the header with its checksum field zeroed, then
+// the sections, so a flipped bit anywhere in the file is caught.
+inline uint64_t dfaImageChecksum(const DFAImageHeader &header, const unsigned char *image)
+{
+    DFAImageHeader unsummed = header;
+    unsummed.checksum = 0;
+    uint64_t h = dfaImageChecksum((const unsigned char *)&unsummed, sizeof(unsummed));
+    return dfaImageChecksum(image + sizeof(DFAImageHeader), header.fileSize - sizeof(DFAImageHeader), h);
+}
+
+// Writes `dfa` as an image. The file is written next to `path` and renamed
+// into place, so processes mapping `path` never see a partial image. Returns
+// false on an I/O error.
+inline bool saveDFAImage(const CompiledDFA &dfa, const std::string &path)
+{
+    const uint64_t alignment = DFAImageHeader::ALIGNMENT;
+    auto align = [&](uint64_t offset) { return (offset + alignment - 1) / alignment * alignment; };
+    DFAImageHeader header = {};
+    memcpy(header.magic, DFAImageHeader::MAGIC, sizeof(header.magic));
+    header.version = DFAImageHeader::VERSION;
+    header.endianTag = DFAImageHeader::ENDIAN_TAG;
+    header.stateCount = dfa.stateCount;
+    header.classCount = dfa.classCount;
+    header.startState = dfa.startState;
+    header.byteClassOffset = align(sizeof(DFAImageHeader));
+    header.tableOffset = align(header.byteClassOffset + dfa.byteClass.size());
+    header.acceptOffset = align(header.tableOffset + dfa.table.size() * sizeof(int32_t));
+    header.fileSize = header.acceptOffset + dfa.acceptBits.size() * sizeof(uint64_t);
+
+    std::string image(header.fileSize, '\0');
+    memcpy(&image[header.byteClassOffset], dfa.byteClass.data(), dfa.byteClass.size());
+    memcpy(&image[header.tableOffset], dfa.table.data(), dfa.table.size() * sizeof(int32_t));
+    memcpy(&image[header.acceptOffset], dfa.acceptBits.data(), dfa.acceptBits.size() * sizeof(uint64_t));
+    header.checksum = dfaImageChecksum(header, (const unsigned char *)image.data());
+    memcpy(&image[0], &header, sizeof(header));
+
+    std::string temporary = path + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out.write(image.data(), image.size()) || !out.flush())
+        {
+            remove(temporary.c_str());
+            return false;
+        }
+    }
+    if (rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+// A DFA image mapped read-only; view() points straight into the mapping, so
+// nothing is parsed or copied and processes that map the same file share its
+// page-cache pages. The header's sizes and offsets are always checked;
+// verifyChecksum additionally reads every page and checks the byte classes
+// and transitions, without which the table is trusted as written.
+class MappedDFA
+{
+public:
+    MappedDFA() = default;
+    MappedDFA(const MappedDFA &) = delete;
+    MappedDFA &operator=(const MappedDFA &) = delete;
+
+    MappedDFA(MappedDFA &&other) noexcept { *this = std::move(other); }
+
+    MappedDFA &operator=(MappedDFA &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            std::swap(base, other.base);
+            std::swap(length, other.length);
+            std::swap(dfa, other.dfa);
+            std::swap(message, other.message);
+        }
+        return *this;
+    }
+
+    ~MappedDFA() { close(); }
+
+    // Returns false with error() set if the file cannot be mapped or is not a
+    // valid image for this build.
+    bool open(const std::string &path, bool verifyChecksum = true)
+    {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return fail("cannot open " + path);
+        struct stat info;
+        if (fstat(fd, &info) < 0 || size_t(info.st_size) < sizeof(DFAImageHeader))
+        {
+            ::close(fd);
+            return fail("file too small for a DFA image header");
+        }
+        length = info.st_size;
+        void *mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+        {
+            length = 0;
+            return fail("cannot map " + path);
+        }
+        base = mapped;
+
+        const unsigned char *bytes = (const unsigned char *)base;
+        DFAImageHeader header;
+        memcpy(&header, bytes, sizeof(header));
+        if (memcmp(header.magic, DFAImageHeader::MAGIC, sizeof(header.magic)) != 0)
+            return fail("not a DFA image");
+        if (header.version != DFAImageHeader::VERSION)
+            return fail("unsupported DFA image version " + std::to_string(header.version));
+        if (header.endianTag != DFAImageHeader::ENDIAN_TAG)
+            return fail("DFA image has the wrong byte order");
+        if (header.fileSize != length)
+            return fail("DFA image is truncated or has trailing data");
+
+        uint64_t tableBytes = uint64_t(header.stateCount) * header.classCount * sizeof(int32_t);
+        uint64_t acceptBytes = (uint64_t(header.stateCount) + 63) / 64 * sizeof(uint64_t);
+        auto aligned = [](uint64_t offset) { return offset % DFAImageHeader::ALIGNMENT == 0; };
+        bool layoutValid = header.byteClassOffset <= length && header.tableOffset <= length && header.acceptOffset <= length &&
+                           header.stateCount >= 1 && header.stateCount <= INT32_MAX && header.classCount >= 1 &&
+                           header.classCount <= 256 && header.startState >= 0 && uint32_t(header.startState) < header.stateCount &&
+                           aligned(header.byteClassOffset) && aligned(header.tableOffset) && aligned(header.acceptOffset) &&
+                           header.byteClassOffset >= sizeof(DFAImageHeader) && header.tableOffset >= header.byteClassOffset + 256 &&
+                           header.acceptOffset >= header.tableOffset + tableBytes && header.acceptOffset + acceptBytes == length;
+        if (!layoutValid)
+            return fail("DFA image header is inconsistent");
+
+        if (verifyChecksum)
+        {
+            if (dfaImageChecksum(header, bytes) != header.checksum)
+                return fail("DFA image checksum mismatch");
+            for (int b = 0; b < 256; b++)
+                if (bytes[header.byteClassOffset + b] >= header.classCount)
+                    return fail("DFA image byte class out of range");
+            const int32_t *table = (const int32_t *)(bytes + header.tableOffset);
+            for (uint64_t i = 0; i < tableBytes / sizeof(int32_t); i++)
+                if (table[i] < 0 || uint32_t(table[i]) >= header.stateCount)
+                    return fail("DFA image transition out of range");
+        }
+
+        dfa.byteClass = bytes + header.byteClassOffset;
+        dfa.table = (const int32_t *)(bytes + header.tableOffset);
+        dfa.acceptBits = (const uint64_t *)(bytes + header.acceptOffset);
+        dfa.classCount = header.classCount;
+        dfa.stateCount = header.stateCount;
+        dfa.startState = header.startState;
+        message.clear();
+        return true;
+    }
+
+    void close()
+    {
+        if (base)
+            munmap(base, length);
+        base = nullptr;
+        length = 0;
+        dfa = DFAView();
+    }
+
+    bool isOpen() const { return base != nullptr; }
+    const std::string &error() const { return message; }
+    const DFAView &view() const { return dfa; }
+    bool matches(std::string_view input) const { return dfa.matches(input); }
+
+private:
+    void *base = nullptr;
+    size_t length = 0;
+    DFAView dfa;
+    std::string message;
+
+    bool fail(const std::string &reason)
+    {
+        close();
+        message = reason;
+        return false;
+    }
+};
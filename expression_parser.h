@@ -0,0 +1,387 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cctype>
+#include <climits>
+#include <cstdint>
+#include "token_buffer.h"
+
+// AST for arithmetic expressions. Nodes live in one contiguous array and refer
+// to each other by index; identifier names live in a SymbolTable arena. A
+// child is always stored before its parent, so a single forward pass over
+// `nodes` visits the tree in post-order without recursion.
+class ExpressionTree
+{
+public:
+    enum Kind : uint8_t
+    {
+        NUMBER,   // left = index into constants
+        VARIABLE, // left = symbol id
+        NEGATE,   // left = operand
+        ADD,
+        SUBTRACT,
+        MULTIPLY,
+        DIVIDE,
+        MODULO
+    };
+
+    struct Node
+    {
+        Kind kind;
+        uint32_t left;
+        uint32_t right;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<long long> constants;
+    SymbolTable symbols;
+    uint32_t root = 0;
+
+    uint32_t addNumber(long long value)
+    {
+        constants.push_back(value);
+        return addNode(NUMBER, constants.size() - 1, 0);
+    }
+
+    uint32_t addNode(Kind kind, uint32_t left, uint32_t right)
+    {
+        nodes.push_back({kind, left, right});
+        return nodes.size() - 1;
+    }
+
+    // Releases every node, constant and name at once.
+    void clear()
+    {
+        nodes.clear();
+        constants.clear();
+        symbols.clear();
+        root = 0;
+    }
+
+    // Evaluates the tree with 64-bit wrap-around arithmetic. Fails on an
+    // empty tree, an unbound variable or division by zero, describing why in
+    // `error`.
+    bool evaluate(const std::unordered_map<std::string, long long> &variables, long long &result, std::string *error = nullptr) const
+    {
+        if (nodes.empty())
+        {
+            if (error)
+                *error = "empty expression";
+            return false;
+        }
+        std::vector<long long> bound(symbols.size());
+        std::vector<bool> isBound(symbols.size(), false);
+        for (uint32_t id = 0; id < symbols.size(); id++)
+        {
+            auto it = variables.find(std::string(symbols.name(id)));
+            if (it != variables.end())
+            {
+                bound[id] = it->second;
+                isBound[id] = true;
+            }
+        }
+
+        std::vector<long long> values(nodes.size());
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            const Node &n = nodes[i];
+            if (n.kind == VARIABLE && !isBound[n.left])
+            {
+                if (error)
+                    *error = "unbound variable " + std::string(symbols.name(n.left));
+                return false;
+            }
+            if ((n.kind == DIVIDE || n.kind == MODULO) && values[n.right] == 0)
+            {
+                if (error)
+                    *error = "division by zero";
+                return false;
+            }
+            if (n.kind == NUMBER)
+                values[i] = constants[n.left];
+            else if (n.kind == VARIABLE)
+                values[i] = bound[n.left];
+            else
+                values[i] = apply(n, values);
+        }
+        result = values[root];
+        return true;
+    }
+
+    // Replaces every subtree without variables by its value, in place. Nodes
+    // that become unreachable stay in the array until the next clear().
+    // Divisions by zero are left unfolded so evaluate() still reports them.
+    void foldConstants()
+    {
+        std::vector<long long> values(nodes.size());
+        std::vector<bool> isConstant(nodes.size(), false);
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            Node &n = nodes[i];
+            if (n.kind == NUMBER)
+            {
+                values[i] = constants[n.left];
+                isConstant[i] = true;
+                continue;
+            }
+            if (n.kind == VARIABLE)
+                continue;
+            bool foldable = n.kind == NEGATE ? isConstant[n.left] : isConstant[n.left] && isConstant[n.right];
+            if (!foldable || ((n.kind == DIVIDE || n.kind == MODULO) && values[n.right] == 0))
+                continue;
+            values[i] = apply(n, values);
+            isConstant[i] = true;
+            constants.push_back(values[i]);
+            n = {NUMBER, uint32_t(constants.size() - 1), 0};
+        }
+    }
+
+    // Fully parenthesized rendering, built with an explicit stack so deep
+    // trees do not exhaust the call stack.
+    std::string toString() const
+    {
+        if (nodes.empty())
+            return "";
+        std::string out;
+        std::vector<std::pair<uint32_t, int>> stack = {{root, 0}}; // (node, children already emitted)
+        while (!stack.empty())
+        {
+            auto &[index, stage] = stack.back();
+            const Node &n = nodes[index];
+            if (n.kind == NUMBER || n.kind == VARIABLE)
+            {
+                out += n.kind == NUMBER ? std::to_string(constants[n.left]) : std::string(symbols.name(n.left));
+                stack.pop_back();
+            }
+            else if (n.kind == NEGATE)
+            {
+                if (stage++ == 0)
+                {
+                    out += "(-";
+                    stack.push_back({n.left, 0});
+                }
+                else
+                {
+                    out += ')';
+                    stack.pop_back();
+                }
+            }
+            else
+            {
+                int s = stage++;
+                if (s == 0)
+                {
+                    out += '(';
+                    stack.push_back({n.left, 0});
+                }
+                else if (s == 1)
+                {
+                    out += std::string(" ") + "+-*/%"[n.kind - ADD] + " ";
+                    stack.push_back({n.right, 0});
+                }
+                else
+                {
+                    out += ')';
+                    stack.pop_back();
+                }
+            }
+        }
+        return out;
+    }
+
+private:
+    static long long apply(const Node &n, const std::vector<long long> &values)
+    {
+        unsigned long long a = values[n.left], b = n.kind == NEGATE ? 0 : values[n.right];
+        switch (n.kind)
+        {
+        case NEGATE:
+            return (long long)(0 - a);
+        case ADD:
+            return (long long)(a + b);
+        case SUBTRACT:
+            return (long long)(a - b);
+        case MULTIPLY:
+            return (long long)(a * b);
+        case DIVIDE:
+            return (long long)b == -1 ? (long long)(0 - a) : values[n.left] / values[n.right];
+        case MODULO:
+            return (long long)b == -1 ? 0 : values[n.left] % values[n.right];
+        default:
+            return 0;
+        }
+    }
+};
+
+// Precedence-climbing (shunting-yard) parser for + - * / %, unary minus,
+// parentheses, multi-digit integers and identifiers. It keeps operands and
+// pending operators on explicit stacks, so nesting depth is bounded only by
+// memory and the whole parse is linear in the input length.
+class PrattParser
+{
+    enum Op : uint8_t
+    {
+        OPEN_PAREN,
+        UNARY_MINUS,
+        BINARY
+    };
+
+    struct PendingOp
+    {
+        Op op;
+        ExpressionTree::Kind kind; // for BINARY
+        size_t offset;             // reported for an unclosed '('
+    };
+
+    std::vector<uint32_t> operands;
+    std::vector<PendingOp> operators;
+    size_t errorPos = 0;
+
+    static int precedence(ExpressionTree::Kind kind)
+    {
+        return kind == ExpressionTree::ADD || kind == ExpressionTree::SUBTRACT ? 1 : 2;
+    }
+
+    static bool binaryKind(char c, ExpressionTree::Kind &kind)
+    {
+        switch (c)
+        {
+        case '+':
+            kind = ExpressionTree::ADD;
+            return true;
+        case '-':
+            kind = ExpressionTree::SUBTRACT;
+            return true;
+        case '*':
+            kind = ExpressionTree::MULTIPLY;
+            return true;
+        case '/':
+            kind = ExpressionTree::DIVIDE;
+            return true;
+        case '%':
+            kind = ExpressionTree::MODULO;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void reduce(ExpressionTree &tree)
+    {
+        PendingOp top = operators.back();
+        operators.pop_back();
+        if (top.op == UNARY_MINUS)
+        {
+            operands.back() = tree.addNode(ExpressionTree::NEGATE, operands.back(), 0);
+            return;
+        }
+        uint32_t right = operands.back();
+        operands.pop_back();
+        operands.back() = tree.addNode(top.kind, operands.back(), right);
+    }
+
+    bool fail(size_t offset)
+    {
+        errorPos = offset;
+        return false;
+    }
+
+public:
+    // Parses `expr` into `tree` (which is cleared first). On failure returns
+    // false and errorOffset() is the byte offset where parsing stopped.
+    bool parse(std::string_view expr, ExpressionTree &tree)
+    {
+        tree.clear();
+        operands.clear();
+        operators.clear();
+        errorPos = 0;
+
+        bool expectOperand = true;
+        size_t i = 0, n = expr.size();
+        while (true)
+        {
+            while (i < n && isspace((unsigned char)expr[i]))
+                i++;
+            if (i == n)
+                break;
+            char c = expr[i];
+
+            if (expectOperand)
+            {
+                if (c == '(' || c == '-')
+                {
+                    operators.push_back({c == '(' ? OPEN_PAREN : UNARY_MINUS, ExpressionTree::ADD, i});
+                    i++;
+                }
+                else if (isdigit((unsigned char)c))
+                {
+                    size_t start = i;
+                    unsigned long long value = 0;
+                    for (; i < n && isdigit((unsigned char)expr[i]); i++)
+                    {
+                        if (value > (unsigned long long)(LLONG_MAX - (expr[i] - '0')) / 10)
+                            return fail(start); // literal does not fit in 64 bits
+                        value = value * 10 + (expr[i] - '0');
+                    }
+                    operands.push_back(tree.addNumber(value));
+                    expectOperand = false;
+                }
+                else if (isalpha((unsigned char)c) || c == '_')
+                {
+                    size_t start = i;
+                    while (i < n && (isalnum((unsigned char)expr[i]) || expr[i] == '_'))
+                        i++;
+                    operands.push_back(tree.addNode(ExpressionTree::VARIABLE, tree.symbols.intern(expr.substr(start, i - start)), 0));
+                    expectOperand = false;
+                }
+                else
+                {
+                    return fail(i);
+                }
+                continue;
+            }
+
+            ExpressionTree::Kind kind;
+            if (binaryKind(c, kind))
+            {
+                // Left-associative: reduce everything that binds at least as tightly.
+                while (!operators.empty() && operators.back().op != OPEN_PAREN &&
+                       (operators.back().op == UNARY_MINUS || precedence(operators.back().kind) >= precedence(kind)))
+                    reduce(tree);
+                operators.push_back({BINARY, kind, i});
+                expectOperand = true;
+                i++;
+            }
+            else if (c == ')')
+            {
+                while (!operators.empty() && operators.back().op != OPEN_PAREN)
+                    reduce(tree);
+                if (operators.empty())
+                    return fail(i); // unmatched ')'
+                operators.pop_back();
+                i++;
+            }
+            else
+            {
+                return fail(i);
+            }
+        }
+
+        if (expectOperand)
+            return fail(i); // empty input or trailing operator
+        while (!operators.empty())
+        {
+            if (operators.back().op == OPEN_PAREN)
+                return fail(operators.back().offset); // unclosed '('
+            reduce(tree);
+        }
+        tree.root = operands.back();
+        return true;
+    }
+
+    size_t errorOffset() const { return errorPos; }
+};
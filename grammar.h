@@ -0,0 +1,328 @@
+#pragma once
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include "token_buffer.h"
+#include "metrics.h"
+
+// Bitset over dense terminal (or nonterminal) indexes.
+class SymbolSet {
+public:
+    std::vector<uint64_t> words;
+
+    SymbolSet() {}
+    explicit SymbolSet(size_t size) : words((size + 63) / 64, 0) {}
+
+    bool insert(uint32_t i) {
+        uint64_t bit = uint64_t(1) << (i & 63), old = words[i >> 6];
+        words[i >> 6] = old | bit;
+        return !(old & bit);
+    }
+    bool contains(uint32_t i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+
+    // Function to add every member of `other`; returns whether anything was new
+    bool unite(const SymbolSet &other) {
+        uint64_t added = 0;
+        for (size_t i = 0; i < words.size(); i++) {
+            added |= other.words[i] & ~words[i];
+            words[i] |= other.words[i];
+        }
+        return added != 0;
+    }
+
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        for (size_t i = 0; i < words.size(); i++)
+            for (uint64_t w = words[i]; w; w &= w - 1) visit(uint32_t(i * 64 + __builtin_ctzll(w)));
+    }
+
+    bool operator==(const SymbolSet &other) const { return words == other.words; }
+};
+
+// Context-free grammar over interned symbols. Every name gets a symbol id from
+// `names`; terminals and nonterminals additionally get dense indexes of their
+// own (in order of declaration) so per-symbol tables and bitsets stay compact.
+// Terminal 0 is always the end marker "$".
+class Grammar {
+public:
+    struct Production {
+        uint32_t head;         // symbol id
+        std::vector<uint32_t> body; // symbol ids, empty for ε
+    };
+
+    static constexpr uint32_t endMarker = 0; // symbol id and terminal index of "$"
+
+    SymbolTable names;
+    std::vector<bool> isNonTerminal; // by symbol id
+    std::vector<uint32_t> index;     // by symbol id: dense terminal or nonterminal index
+    std::vector<uint32_t> terminals, nonTerminals; // dense index -> symbol id
+    std::vector<Production> productions;
+    std::vector<std::vector<uint32_t>> rules; // by nonterminal index: production numbers
+    uint32_t start = UINT32_MAX;
+
+    Grammar() { addTerminal("$"); }
+
+    // Function to look up or declare a nonterminal; the first one declared is the start symbol
+    uint32_t addNonTerminal(std::string_view name) {
+        uint32_t id = intern(name, true);
+        if (start == UINT32_MAX) start = id;
+        return id;
+    }
+
+    uint32_t addTerminal(std::string_view name) { return intern(name, false); }
+
+    // Function to find a symbol by name, or UINT32_MAX if it was never declared
+    uint32_t find(std::string_view name) const {
+        uint32_t id = names.find(name);
+        return id < isNonTerminal.size() ? id : UINT32_MAX;
+    }
+
+    uint32_t addProduction(uint32_t head, std::vector<uint32_t> body) {
+        uint32_t number = productions.size();
+        productions.push_back({head, std::move(body)});
+        rules[index[head]].push_back(number);
+        return number;
+    }
+
+    size_t terminalCount() const { return terminals.size(); }
+    size_t nonTerminalCount() const { return nonTerminals.size(); }
+    std::string_view name(uint32_t symbol) const { return names.name(symbol); }
+
+    // Function to render a production as "A -> X Y Z" (or "A -> ε")
+    std::string productionText(uint32_t number, const char *separator = " ") const {
+        const Production &production = productions[number];
+        std::string text = std::string(name(production.head)) + " -> ";
+        if (production.body.empty()) return text + "ε";
+        for (size_t i = 0; i < production.body.size(); i++) text += (i ? separator : "") + std::string(name(production.body[i]));
+        return text;
+    }
+
+    // Function to split a production string into symbol ids. Whitespace separates
+    // symbols when present; otherwise the longest declared nonterminal name wins at
+    // each position and any other character is a one-character terminal.
+    std::vector<uint32_t> splitProduction(std::string_view text, size_t longestName) {
+        std::vector<uint32_t> body;
+        if (text == "ε") return body;
+        bool spaced = text.find(' ') != std::string_view::npos;
+        size_t i = 0;
+        while (i < text.size()) {
+            if (text[i] == ' ') {
+                i++;
+                continue;
+            }
+            size_t length = 0;
+            if (spaced) {
+                size_t end = text.find(' ', i);
+                length = (end == std::string_view::npos ? text.size() : end) - i;
+            } else {
+                for (size_t n = std::min(longestName, text.size() - i); n > 0 && !length; n--) {
+                    uint32_t id = find(text.substr(i, n));
+                    if (id != UINT32_MAX && isNonTerminal[id]) length = n;
+                }
+                if (!length) length = 1;
+            }
+            std::string_view symbol = text.substr(i, length);
+            if (symbol != "ε") {
+                uint32_t id = find(symbol);
+                body.push_back(id != UINT32_MAX ? id : addTerminal(symbol));
+            }
+            i += length;
+        }
+        return body;
+    }
+
+    // Function to build a grammar from the string form used by 06 and 07; every key is
+    // a nonterminal and `startName` (default: the first key) is the start symbol
+    static Grammar fromRules(const std::map<std::string, std::vector<std::string>> &rules, std::string_view startName = "") {
+        Grammar grammar;
+        size_t longestName = 0;
+        if (!startName.empty()) grammar.addNonTerminal(startName);
+        for (const auto &rule : rules) {
+            grammar.addNonTerminal(rule.first);
+            longestName = std::max(longestName, rule.first.size());
+        }
+        for (const auto &rule : rules) {
+            uint32_t head = grammar.find(rule.first);
+            for (const std::string &production : rule.second) {
+                grammar.addProduction(head, grammar.splitProduction(production, longestName));
+            }
+        }
+        return grammar;
+    }
+
+    // Function to declare every symbol of `other` (nonterminals first, in order) and its
+    // start symbol; returns the new id of each of other's symbol ids
+    std::vector<uint32_t> declareSymbolsOf(const Grammar &other) {
+        std::vector<uint32_t> remap(other.isNonTerminal.size());
+        for (uint32_t nt : other.nonTerminals) remap[nt] = addNonTerminal(other.name(nt));
+        for (uint32_t t : other.terminals) remap[t] = addTerminal(other.name(t));
+        if (other.start != UINT32_MAX) start = remap[other.start];
+        return remap;
+    }
+
+    // Function to declare a nonterminal named `base` + `suffix` + a number, choosing the
+    // first number from `counter` on that no existing symbol uses
+    uint32_t addFreshNonTerminal(std::string_view base, std::string_view suffix, int &counter) {
+        std::string name;
+        do {
+            name = std::string(base) + std::string(suffix) + std::to_string(counter++);
+        } while (find(name) != UINT32_MAX);
+        return addNonTerminal(name);
+    }
+
+    // Function to convert back to the string form, joining symbols with `separator`
+    // (pass " " when names are longer than one character)
+    std::map<std::string, std::vector<std::string>> toRules(const char *separator = "") const {
+        std::map<std::string, std::vector<std::string>> result;
+        for (uint32_t nt : nonTerminals) {
+            std::vector<std::string> &alternatives = result[std::string(name(nt))];
+            for (uint32_t number : rules[index[nt]]) {
+                const Production &production = productions[number];
+                std::string text;
+                for (uint32_t symbol : production.body) text += (text.empty() ? "" : separator) + std::string(name(symbol));
+                alternatives.push_back(production.body.empty() ? "ε" : text);
+            }
+        }
+        return result;
+    }
+
+private:
+    uint32_t intern(std::string_view name, bool nonTerminal) {
+        uint32_t id = names.intern(name);
+        if (id < isNonTerminal.size()) return id;
+        isNonTerminal.push_back(nonTerminal);
+        std::vector<uint32_t> &dense = nonTerminal ? nonTerminals : terminals;
+        index.push_back(dense.size());
+        dense.push_back(id);
+        if (nonTerminal) rules.emplace_back();
+        return id;
+    }
+};
+
+// FIRST, FOLLOW and nullable for every nonterminal, by nonterminal index.
+// FIRST/FOLLOW are bitsets over terminal indexes; ε is represented by `nullable`.
+struct FirstFollowSets {
+    std::vector<bool> nullable;
+    std::vector<SymbolSet> first, follow;
+};
+
+// Function to compute FIRST of a symbol string into `out`; returns whether the string is nullable
+inline bool firstOfSequence(const Grammar &grammar, const FirstFollowSets &sets, const uint32_t *begin, const uint32_t *end,
+                            SymbolSet &out) {
+    for (const uint32_t *symbol = begin; symbol != end; symbol++) {
+        uint32_t i = grammar.index[*symbol];
+        if (!grammar.isNonTerminal[*symbol]) {
+            out.insert(i);
+            return false;
+        }
+        out.unite(sets.first[i]);
+        if (!sets.nullable[i]) return false;
+    }
+    return true;
+}
+
+// Function to compute nullable, FIRST and FOLLOW as least fixed points. Each
+// inclusion FIRST(A) ⊇ FIRST(B) or FOLLOW(B) ⊇ FOLLOW(A) becomes an edge, and a
+// worklist re-propagates only from the sets that actually grew.
+inline FirstFollowSets computeFirstFollowSets(const Grammar &grammar) {
+    CDLAB_TIME_SCOPE(Metric::FIRST_FOLLOW_SECONDS);
+    size_t nts = grammar.nonTerminalCount(), ts = grammar.terminalCount();
+    FirstFollowSets sets{std::vector<bool>(nts, false), std::vector<SymbolSet>(nts, SymbolSet(ts)), std::vector<SymbolSet>(nts, SymbolSet(ts))};
+
+    // Nullable: count the not-yet-nullable symbols of each production
+    std::vector<uint32_t> remaining(grammar.productions.size());
+    std::vector<std::vector<uint32_t>> occursIn(nts); // nonterminal -> productions containing it
+    std::deque<uint32_t> work;
+    for (uint32_t p = 0; p < grammar.productions.size(); p++) {
+        const Grammar::Production &production = grammar.productions[p];
+        bool hasTerminal = false;
+        for (uint32_t symbol : production.body) hasTerminal |= !grammar.isNonTerminal[symbol];
+        if (hasTerminal) continue;
+        remaining[p] = production.body.size();
+        for (uint32_t symbol : production.body) occursIn[grammar.index[symbol]].push_back(p);
+        uint32_t head = grammar.index[production.head];
+        if (remaining[p] == 0 && !sets.nullable[head]) {
+            sets.nullable[head] = true;
+            work.push_back(head);
+        }
+    }
+    while (!work.empty()) {
+        uint32_t nt = work.front();
+        work.pop_front();
+        CDLAB_COUNT(Metric::NULLABLE_STEPS, 1);
+        for (uint32_t p : occursIn[nt]) {
+            uint32_t head = grammar.index[grammar.productions[p].head];
+            if (--remaining[p] == 0 && !sets.nullable[head]) {
+                sets.nullable[head] = true;
+                work.push_back(head);
+            }
+        }
+    }
+
+    // Propagates along `edges` until no set changes
+    auto propagate = [&](std::vector<SymbolSet> &target, const std::vector<std::vector<uint32_t>> &edges, Metric steps) {
+        std::vector<bool> queued(nts, true);
+        for (uint32_t nt = 0; nt < nts; nt++) work.push_back(nt);
+        while (!work.empty()) {
+            uint32_t from = work.front();
+            work.pop_front();
+            queued[from] = false;
+            CDLAB_COUNT(steps, 1);
+            for (uint32_t to : edges[from]) {
+                if (target[to].unite(target[from]) && !queued[to]) {
+                    queued[to] = true;
+                    work.push_back(to);
+                }
+            }
+        }
+    };
+
+    // FIRST: terminals seen directly, edges B -> A for every B in a nullable prefix of A's body
+    std::vector<std::vector<uint32_t>> firstEdges(nts);
+    for (const Grammar::Production &production : grammar.productions) {
+        uint32_t head = grammar.index[production.head];
+        for (uint32_t symbol : production.body) {
+            uint32_t i = grammar.index[symbol];
+            if (!grammar.isNonTerminal[symbol]) {
+                sets.first[head].insert(i);
+                break;
+            }
+            if (i != head) firstEdges[i].push_back(head);
+            if (!sets.nullable[i]) break;
+        }
+    }
+    propagate(sets.first, firstEdges, Metric::FIRST_STEPS);
+
+    // FOLLOW: FIRST of each suffix directly, edges A -> B when B ends a nullable suffix of A's body
+    std::vector<std::vector<uint32_t>> followEdges(nts);
+    if (grammar.start != UINT32_MAX) sets.follow[grammar.index[grammar.start]].insert(Grammar::endMarker);
+    SymbolSet trailer(ts);
+    for (const Grammar::Production &production : grammar.productions) {
+        uint32_t head = grammar.index[production.head];
+        bool suffixNullable = true;
+        std::fill(trailer.words.begin(), trailer.words.end(), 0);
+        for (size_t k = production.body.size(); k-- > 0;) {
+            uint32_t symbol = production.body[k], i = grammar.index[symbol];
+            if (!grammar.isNonTerminal[symbol]) {
+                std::fill(trailer.words.begin(), trailer.words.end(), 0);
+                trailer.insert(i);
+                suffixNullable = false;
+                continue;
+            }
+            sets.follow[i].unite(trailer);
+            if (suffixNullable && i != head) followEdges[head].push_back(i);
+            if (!sets.nullable[i]) {
+                std::fill(trailer.words.begin(), trailer.words.end(), 0);
+                suffixNullable = false;
+            }
+            trailer.unite(sets.first[i]);
+        }
+    }
+    propagate(sets.follow, followEdges, Metric::FOLLOW_STEPS);
+    return sets;
+}
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include "lexical_analyzer.h"
+
+// Text with a movable gap at the last edit, so an edit only moves the bytes
+// between it and the previous one.
+class GapBuffer
+{
+    std::vector<char> data;
+    size_t gapStart = 0, gapEnd = 0;
+
+public:
+    size_t size() const { return data.size() - (gapEnd - gapStart); }
+
+    void assign(std::string_view text)
+    {
+        data.assign(text.begin(), text.end());
+        gapStart = gapEnd = data.size();
+    }
+
+    // Moves the gap to `pos` and returns the text before and after it; each
+    // half is contiguous until the next edit.
+    std::pair<std::string_view, std::string_view> split(size_t pos)
+    {
+        size_t gap = gapEnd - gapStart;
+        if (pos < gapStart)
+            std::move_backward(data.begin() + pos, data.begin() + gapStart, data.begin() + gapEnd);
+        else if (pos > gapStart)
+            std::move(data.begin() + gapEnd, data.begin() + gapEnd + (pos - gapStart), data.begin() + gapStart);
+        gapStart = pos;
+        gapEnd = pos + gap;
+        return {std::string_view(data.data(), gapStart), std::string_view(data.data() + gapEnd, data.size() - gapEnd)};
+    }
+
+    void replace(size_t pos, size_t deleted, std::string_view inserted)
+    {
+        split(pos);
+        gapEnd += deleted;
+        if (gapEnd - gapStart < inserted.size())
+        {
+            size_t tail = data.size() - gapEnd;
+            std::vector<char> grown(std::max(data.size() * 2, size() + inserted.size() + 256));
+            std::copy(data.begin(), data.begin() + gapStart, grown.begin());
+            std::copy(data.begin() + gapEnd, data.end(), grown.end() - tail);
+            gapEnd = grown.size() - tail;
+            data.swap(grown);
+        }
+        std::copy(inserted.begin(), inserted.end(), data.begin() + gapStart);
+        gapStart += inserted.size();
+    }
+
+    std::string text() const
+    {
+        std::string result(data.begin(), data.begin() + gapStart);
+        result.append(data.begin() + gapEnd, data.end());
+        return result;
+    }
+};
+
+// Prefix sums with point updates, plus a search for the entry covering a
+// position; all O(log n).
+class FenwickTree
+{
+    std::vector<uint64_t> tree; // 1-based
+
+public:
+    size_t size() const { return tree.empty() ? 0 : tree.size() - 1; }
+
+    void assign(const std::vector<uint64_t> &values)
+    {
+        tree.assign(values.size() + 1, 0);
+        for (size_t i = 1; i < tree.size(); i++)
+        {
+            tree[i] += values[i - 1];
+            size_t parent = i + (i & -i);
+            if (parent < tree.size())
+                tree[parent] += tree[i];
+        }
+    }
+
+    void add(size_t index, int64_t delta)
+    {
+        for (size_t i = index + 1; i < tree.size(); i += i & -i)
+            tree[i] += delta;
+    }
+
+    // Sum of the first `count` entries.
+    uint64_t prefix(size_t count) const
+    {
+        uint64_t sum = 0;
+        for (size_t i = count; i > 0; i -= i & -i)
+            sum += tree[i];
+        return sum;
+    }
+
+    // Smallest index whose prefix sum through it exceeds `pos`, or size().
+    size_t find(uint64_t pos) const
+    {
+        size_t index = 0, step = 1;
+        while (step * 2 < tree.size())
+            step *= 2;
+        for (; step > 0; step /= 2)
+        {
+            if (index + step < tree.size() && tree[index + step] <= pos)
+            {
+                index += step;
+                pos -= tree[index];
+            }
+        }
+        return index;
+    }
+};
+
+// LexicalAnalyzer's token stream kept up to date under edits. Tokens live in
+// blocks that tile the text; each block stores offsets and lines relative to
+// its own start, and block starts are prefix sums over Fenwick trees of block
+// byte and newline spans, so an edit shifts every later token by updating
+// one entry instead of rewriting them. The lexer carries no state across a
+// newline, so an edit is re-lexed from the start of its first line to the end
+// of its last line, where the new stream always resynchronizes with the old
+// one. The work per edit is the edited lines plus the blocks they fall in,
+// independent of the file size; only a change in the number of blocks (a
+// split every few hundred tokens of growth, or an edit spanning blocks)
+// rebuilds the block index.
+class IncrementalLexer
+{
+public:
+    using TokenType = LexicalAnalyzer::TokenType;
+
+    struct EditStats
+    {
+        size_t relexedBytes = 0;
+        size_t relexedTokens = 0;
+        size_t rebuiltBlocks = 0;
+    };
+
+    explicit IncrementalLexer(size_t blockTokens = 256) : blockTokens(std::max<size_t>(blockTokens, 1))
+    {
+        analyze({});
+    }
+
+    void analyze(std::string_view code)
+    {
+        source.assign(code);
+        symbols.clear();
+        symbolTypes.clear();
+
+        TokenBuffer all;
+        int lineNumber = 1;
+        LexicalAnalyzer::scan(code, true, lineNumber, [&](std::string_view token, int line)
+                              { addToken(all, token, token.data() - code.data(), line - 1); });
+        tokenCount = all.size();
+        blocks.clear();
+        cut(all, code.size(), lineNumber - 1, blocks);
+        rebuildIndex();
+    }
+
+    // Replaces `deleted` bytes at `offset` with `inserted`. Both are clamped
+    // to the text.
+    EditStats edit(size_t offset, size_t deleted, std::string_view inserted)
+    {
+        EditStats stats;
+        size_t oldSize = source.size();
+        offset = std::min(offset, oldSize);
+        deleted = std::min(deleted, oldSize - offset);
+
+        // Old region: from the start of the first edited line to just past the
+        // newline that ends the last one (or the end of the text)
+        auto [before, after] = source.split(offset);
+        size_t regionStart = before.rfind('\n');
+        regionStart = regionStart == std::string_view::npos ? 0 : regionStart + 1;
+        size_t newline = after.find('\n', deleted);
+        size_t oldEnd = newline == std::string_view::npos ? oldSize : offset + newline + 1;
+        int64_t delta = int64_t(inserted.size()) - int64_t(deleted);
+        int64_t lineDelta = std::count(inserted.begin(), inserted.end(), '\n') - std::count(after.begin(), after.begin() + deleted, '\n');
+
+        size_t first = blockAt(regionStart), last = oldEnd > regionStart ? blockAt(oldEnd - 1) : first;
+        uint64_t blockStart = offsets.prefix(first), blockLine = lines.prefix(first);
+        uint64_t oldSpan = offsets.prefix(last + 1) - blockStart, oldLineSpan = lines.prefix(last + 1) - blockLine;
+
+        source.replace(offset, deleted, inserted);
+        auto [head, tail] = source.split(regionStart);
+        size_t newEnd = oldEnd + delta;
+        uint32_t linesBefore = std::count(head.begin() + blockStart, head.end(), '\n');
+
+        // Merged stream relative to blockStart: kept head, re-lexed lines, shifted tail
+        TokenBuffer merged;
+        const TokenBuffer &firstTokens = blocks[first].tokens;
+        for (size_t i = 0; i < firstTokens.size() && blockStart + firstTokens.offsets[i] < regionStart; i++)
+            merged.push(firstTokens.kinds[i], firstTokens.symbols[i], firstTokens.offsets[i], firstTokens.lengths[i], firstTokens.lines[i]);
+
+        std::string_view region = tail.substr(0, newEnd - regionStart);
+        size_t kept = merged.size();
+        int lineNumber = 1;
+        LexicalAnalyzer::scan(region, true, lineNumber, [&](std::string_view token, int line)
+                              { addToken(merged, token, regionStart - blockStart + (token.data() - region.data()), linesBefore + line - 1); });
+        stats.relexedBytes = region.size();
+        stats.relexedTokens = merged.size() - kept;
+
+        size_t removed = 0;
+        uint64_t start = blockStart, line = blockLine;
+        for (size_t b = first; b <= last; b++)
+        {
+            const TokenBuffer &tokens = blocks[b].tokens;
+            removed += tokens.size();
+            for (size_t i = 0; i < tokens.size(); i++)
+            {
+                if (start + tokens.offsets[i] < oldEnd)
+                    continue;
+                merged.push(tokens.kinds[i], tokens.symbols[i], start + tokens.offsets[i] + delta - blockStart, tokens.lengths[i],
+                            line + tokens.lines[i] + lineDelta - blockLine);
+            }
+            start += blocks[b].span;
+            line += blocks[b].lineSpan;
+        }
+        tokenCount += merged.size() - removed;
+
+        std::vector<Block> rebuilt;
+        cut(merged, oldSpan + delta, oldLineSpan + lineDelta, rebuilt);
+        stats.rebuiltBlocks = rebuilt.size();
+        if (rebuilt.size() == last - first + 1)
+        {
+            for (size_t j = 0; j < rebuilt.size(); j++)
+            {
+                offsets.add(first + j, int64_t(rebuilt[j].span) - int64_t(blocks[first + j].span));
+                lines.add(first + j, int64_t(rebuilt[j].lineSpan) - int64_t(blocks[first + j].lineSpan));
+                blocks[first + j] = std::move(rebuilt[j]);
+            }
+        }
+        else
+        {
+            blocks.erase(blocks.begin() + first, blocks.begin() + last + 1);
+            blocks.insert(blocks.begin() + first, std::make_move_iterator(rebuilt.begin()), std::make_move_iterator(rebuilt.end()));
+            rebuildIndex();
+        }
+        return stats;
+    }
+
+    size_t size() const { return tokenCount; }
+    size_t textSize() const { return source.size(); }
+    std::string text() const { return source.text(); }
+    const SymbolTable &symbolTable() const { return symbols; }
+
+    // Calls visit(uint32_t symbol, TokenType type, size_t offset, uint32_t
+    // length, uint32_t line) for every token in order.
+    template <typename Visit>
+    void forEachToken(Visit visit) const
+    {
+        uint64_t start = 0, line = 1;
+        for (const Block &block : blocks)
+        {
+            const TokenBuffer &tokens = block.tokens;
+            for (size_t i = 0; i < tokens.size(); i++)
+                visit(tokens.symbols[i], TokenType(tokens.kinds[i]), start + tokens.offsets[i], tokens.lengths[i], line + tokens.lines[i]);
+            start += block.span;
+            line += block.lineSpan;
+        }
+    }
+
+    // The stream with absolute offsets and lines, as LexicalAnalyzer lays it out.
+    TokenBuffer tokenBuffer() const
+    {
+        TokenBuffer result;
+        result.reserve(tokenCount);
+        forEachToken([&](uint32_t symbol, TokenType type, size_t offset, uint32_t length, uint32_t line)
+                     { result.push(type, symbol, offset, length, line); });
+        return result;
+    }
+
+private:
+    struct Block
+    {
+        TokenBuffer tokens; // offsets and lines relative to the block start
+        uint64_t span = 0;     // bytes covered, up to the next block's start
+        uint64_t lineSpan = 0; // newlines among them
+    };
+
+    GapBuffer source;
+    SymbolTable symbols;
+    std::vector<TokenType> symbolTypes;
+    std::vector<Block> blocks;
+    FenwickTree offsets, lines; // over block spans and line spans
+    size_t blockTokens;
+    size_t tokenCount = 0;
+
+    void addToken(TokenBuffer &into, std::string_view token, uint64_t offset, uint32_t line)
+    {
+        uint32_t symbol = symbols.intern(token);
+        if (symbol == symbolTypes.size())
+            symbolTypes.push_back(LexicalAnalyzer::identifyType(token));
+        into.push(symbolTypes[symbol], symbol, offset, token.size(), line);
+    }
+
+    size_t blockAt(uint64_t pos) const
+    {
+        return std::min(offsets.find(pos), blocks.size() - 1);
+    }
+
+    // Cuts a stream covering `span` bytes and `lineSpan` newlines into blocks
+    // of blockTokens tokens (one block if it holds at most twice that); each
+    // later block starts at its first token.
+    void cut(const TokenBuffer &tokens, uint64_t span, uint64_t lineSpan, std::vector<Block> &out) const
+    {
+        size_t n = tokens.size();
+        size_t chunk = n <= 2 * blockTokens ? std::max<size_t>(n, 1) : blockTokens;
+        uint64_t start = 0, line = 0;
+        for (size_t i = 0; i < std::max<size_t>(n, 1); i += chunk)
+        {
+            size_t end = n - i < 2 * chunk ? n : i + chunk; // the last block takes the remainder
+            Block block;
+            uint64_t nextStart = end < n ? tokens.offsets[end] : span;
+            uint64_t nextLine = end < n ? tokens.lines[end] : lineSpan;
+            block.tokens.reserve(end - i);
+            for (size_t t = i; t < end; t++)
+                block.tokens.push(tokens.kinds[t], tokens.symbols[t], tokens.offsets[t] - start, tokens.lengths[t], tokens.lines[t] - line);
+            block.span = nextStart - start;
+            block.lineSpan = nextLine - line;
+            out.push_back(std::move(block));
+            start = nextStart;
+            line = nextLine;
+            if (end == n)
+                break;
+        }
+    }
+
+    void rebuildIndex()
+    {
+        std::vector<uint64_t> spans, lineSpans;
+        for (const Block &block : blocks)
+        {
+            spans.push_back(block.span);
+            lineSpans.push_back(block.lineSpan);
+        }
+        offsets.assign(spans);
+        lines.assign(lineSpans);
+    }
+};
@@ -0,0 +1,423 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include "grammar.h"
+
+// Sparse 2-D table packed by row displacement (a comb vector): row r's entries
+// live at value[base[r] + column], and check[] names the row that owns each
+// slot. Missing entries fall back to the row's default.
+struct CombTable {
+    std::vector<uint32_t> base;
+    std::vector<int32_t> defaults;
+    std::vector<uint32_t> check;
+    std::vector<int32_t> value;
+
+    int32_t lookup(uint32_t row, uint32_t column) const {
+        size_t i = base[row] + column;
+        return i < check.size() && check[i] == row ? value[i] : defaults[row];
+    }
+
+    size_t bytes() const {
+        return base.size() * sizeof(uint32_t) + defaults.size() * sizeof(int32_t) + check.size() * sizeof(uint32_t) +
+               value.size() * sizeof(int32_t);
+    }
+};
+
+// Function to pack rows of (column, value) pairs, densest first, each at the
+// lowest displacement where it overlaps no occupied slot
+inline CombTable packCombTable(const std::vector<std::vector<std::pair<uint32_t, int32_t>>> &rows, std::vector<int32_t> defaults) {
+    const uint32_t freeSlot = UINT32_MAX;
+    CombTable table;
+    table.base.assign(rows.size(), 0);
+    table.defaults = std::move(defaults);
+
+    std::vector<uint32_t> order(rows.size());
+    for (uint32_t r = 0; r < rows.size(); r++) order[r] = r;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return rows[a].size() > rows[b].size(); });
+
+    size_t firstFree = 0;
+    for (uint32_t r : order) {
+        const std::vector<std::pair<uint32_t, int32_t>> &row = rows[r];
+        if (row.empty()) continue;
+        size_t base = firstFree > row[0].first ? firstFree - row[0].first : 0;
+        for (;; base++) {
+            bool fits = true;
+            for (const auto &entry : row) {
+                size_t i = base + entry.first;
+                if (i < table.check.size() && table.check[i] != freeSlot) {
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits) break;
+        }
+        table.base[r] = base;
+        for (const auto &entry : row) {
+            size_t i = base + entry.first;
+            if (i >= table.check.size()) {
+                table.check.resize(i + 1, freeSlot);
+                table.value.resize(i + 1, 0);
+            }
+            table.check[i] = r;
+            table.value[i] = entry.second;
+        }
+        while (firstFree < table.check.size() && table.check[firstFree] != freeSlot) firstFree++;
+    }
+    return table;
+}
+
+// A cell where two actions competed; `kept` won (shift over reduce, else the
+// earlier production). Actions use the LALRTable encoding.
+struct LALRConflict {
+    uint32_t state, terminal; // terminal is a dense terminal index
+    int32_t kept, dropped;
+};
+
+// LALR(1) tables. ACTION entries are 0 for error, s + 1 to shift to state s and
+// -(p + 1) to reduce by production p; production `accepting` (the augmented
+// S' -> S, numbered after the grammar's own) means accept. GOTO is indexed by
+// (nonterminal index, state), so each nonterminal's most common target becomes
+// its column default.
+struct LALRTable {
+    size_t stateCount = 0;
+    uint32_t accepting = 0;
+    std::vector<uint32_t> productionLength, productionHead; // head as nonterminal index
+    CombTable action, gotoTable;
+    std::vector<LALRConflict> conflicts;
+
+    bool isLALR1() const { return conflicts.empty(); }
+};
+
+// Function to build LALR(1) tables: LR(0) item sets are interned by their sorted
+// kernels, then lookaheads are found by the spontaneous-generation and
+// propagation method (closing each kernel item once with a dummy lookahead)
+// and spread over the propagation graph with a worklist
+inline LALRTable buildLALRTable(const Grammar &grammar, const FirstFollowSets &sets) {
+    CDLAB_TIME_SCOPE(Metric::LALR_SECONDS);
+    uint32_t T = grammar.terminalCount(), N = grammar.nonTerminalCount();
+    uint32_t dummy = T;                  // the '#' lookahead, one past the last terminal
+    auto isNonTerminal = [&](uint32_t x) { return x >= T; }; // dense code: terminal t, nonterminal T + n
+
+    // Productions in dense codes, plus the augmented N -> start as the last one
+    uint32_t P = grammar.productions.size();
+    std::vector<std::vector<uint32_t>> body(P + 1);
+    std::vector<uint32_t> head(P + 1);
+    std::vector<std::vector<uint32_t>> rulesOf(N + 1);
+    for (uint32_t p = 0; p < P; p++) {
+        head[p] = grammar.index[grammar.productions[p].head];
+        for (uint32_t symbol : grammar.productions[p].body)
+            body[p].push_back(grammar.isNonTerminal[symbol] ? T + grammar.index[symbol] : grammar.index[symbol]);
+        rulesOf[head[p]].push_back(p);
+    }
+    head[P] = N;
+    body[P] = {T + grammar.index[grammar.start]};
+    rulesOf[N].push_back(P);
+
+    // Items are numbered densely: production p's items are itemStart[p] + dot
+    std::vector<uint32_t> itemStart(P + 2);
+    for (uint32_t p = 0; p <= P; p++) itemStart[p + 1] = itemStart[p] + body[p].size() + 1;
+    uint32_t itemCount = itemStart[P + 1];
+    std::vector<uint32_t> itemProduction(itemCount), itemNext(itemCount, UINT32_MAX);
+    for (uint32_t p = 0; p <= P; p++) {
+        for (uint32_t dot = 0; dot <= body[p].size(); dot++) {
+            itemProduction[itemStart[p] + dot] = p;
+            if (dot < body[p].size()) itemNext[itemStart[p] + dot] = body[p][dot];
+        }
+    }
+
+    // FIRST of what follows the next symbol of each item, over T + 1 bits
+    std::vector<SymbolSet> restFirst(itemCount, SymbolSet(T + 1));
+    std::vector<bool> restNullable(itemCount, true);
+    for (uint32_t p = 0; p <= P; p++) {
+        for (uint32_t dot = body[p].size(); dot-- > 1;) {
+            uint32_t item = itemStart[p] + dot - 1, x = body[p][dot];
+            restFirst[item] = restFirst[item + 1];
+            restNullable[item] = restNullable[item + 1];
+            if (!isNonTerminal(x)) {
+                std::fill(restFirst[item].words.begin(), restFirst[item].words.end(), 0);
+                restFirst[item].insert(x);
+                restNullable[item] = false;
+                continue;
+            }
+            if (!sets.nullable[x - T]) {
+                std::fill(restFirst[item].words.begin(), restFirst[item].words.end(), 0);
+                restNullable[item] = false;
+            }
+            for (size_t w = 0; w < sets.first[x - T].words.size(); w++) restFirst[item].words[w] |= sets.first[x - T].words[w];
+        }
+    }
+
+    // LR(0) automaton
+    struct KernelHash {
+        size_t operator()(const std::vector<uint32_t> &kernel) const {
+            uint64_t h = 1469598103934665603ull;
+            for (uint32_t item : kernel) {
+                h ^= item;
+                h *= 1099511628211ull;
+            }
+            return h;
+        }
+    };
+    std::vector<std::vector<uint32_t>> kernels = {{itemStart[P]}};
+    std::unordered_map<std::vector<uint32_t>, uint32_t, KernelHash> stateOf = {{kernels[0], 0}};
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> transitions; // (symbol, target), sorted by symbol
+    std::vector<uint32_t> closure, seen(N + 1, UINT32_MAX), touched;
+    std::vector<std::vector<uint32_t>> advanced(T + N + 1);
+
+    auto closeLR0 = [&](uint32_t state) {
+        closure = kernels[state];
+        for (size_t k = 0; k < closure.size(); k++) {
+            uint32_t x = itemNext[closure[k]];
+            if (x == UINT32_MAX || !isNonTerminal(x) || seen[x - T] == state) continue;
+            seen[x - T] = state;
+            for (uint32_t p : rulesOf[x - T]) closure.push_back(itemStart[p]);
+        }
+    };
+
+    for (uint32_t state = 0; state < kernels.size(); state++) {
+        closeLR0(state);
+        touched.clear();
+        for (uint32_t item : closure) {
+            uint32_t x = itemNext[item];
+            if (x == UINT32_MAX) continue;
+            if (advanced[x].empty()) touched.push_back(x);
+            advanced[x].push_back(item + 1);
+        }
+        std::sort(touched.begin(), touched.end());
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        for (uint32_t x : touched) {
+            std::vector<uint32_t> &kernel = advanced[x];
+            std::sort(kernel.begin(), kernel.end());
+            auto [it, inserted] = stateOf.try_emplace(kernel, kernels.size());
+            if (inserted) kernels.push_back(kernel);
+            edges.push_back({x, it->second});
+            kernel.clear();
+        }
+        transitions.push_back(std::move(edges));
+    }
+    uint32_t S = kernels.size();
+
+    // Lookahead slots: one per kernel item, then one per ε-item found in a closure
+    std::vector<uint32_t> slotBase(S + 1);
+    for (uint32_t s = 0; s < S; s++) slotBase[s + 1] = slotBase[s] + kernels[s].size();
+    std::vector<SymbolSet> lookahead(slotBase[S], SymbolSet(T));
+    std::vector<std::vector<uint32_t>> propagate(slotBase[S]);
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> epsilonSlots(S); // (production, slot)
+    auto kernelSlot = [&](uint32_t state, uint32_t item) {
+        const std::vector<uint32_t> &kernel = kernels[state];
+        return slotBase[state] + uint32_t(std::lower_bound(kernel.begin(), kernel.end(), item) - kernel.begin());
+    };
+
+    std::vector<uint32_t> gotoOf(T + N + 1), epsilonSlotOf(P + 1), epsilonStamp(P + 1, UINT32_MAX), reached(N + 1, UINT32_MAX);
+    std::vector<SymbolSet> la(N + 1, SymbolSet(T + 1));
+    std::vector<uint32_t> work;
+    std::vector<bool> inWork(N + 1, false);
+    uint32_t stamp = 0;
+    auto receive = [&](uint32_t from, uint32_t to, const SymbolSet &set) {
+        // Spontaneous terminals go straight into `to`; the dummy means `from` propagates there
+        for (size_t w = 0; w < lookahead[to].words.size(); w++) {
+            uint64_t bits = set.words[w];
+            if (w == dummy >> 6) bits &= ~(uint64_t(1) << (dummy & 63));
+            lookahead[to].words[w] |= bits;
+        }
+        if (set.contains(dummy)) propagate[from].push_back(to);
+    };
+
+    for (uint32_t state = 0; state < S; state++) {
+        for (const auto &edge : transitions[state]) gotoOf[edge.first] = edge.second;
+        for (uint32_t k = 0; k < kernels[state].size(); k++) {
+            uint32_t from = slotBase[state] + k, item = kernels[state][k], x = itemNext[item];
+            if (x == UINT32_MAX) continue;
+            propagate[from].push_back(kernelSlot(gotoOf[x], item + 1));
+            if (!isNonTerminal(x)) continue;
+
+            // LR(1) closure of [item, #], tracked per nonterminal
+            stamp++;
+            touched.clear();
+            auto offer = [&](uint32_t nt, const SymbolSet &first, bool nullable, const SymbolSet &inherited) {
+                bool changed = reached[nt] != stamp;
+                if (changed) {
+                    reached[nt] = stamp;
+                    std::fill(la[nt].words.begin(), la[nt].words.end(), 0);
+                    touched.push_back(nt);
+                }
+                changed |= la[nt].unite(first);
+                if (nullable) changed |= la[nt].unite(inherited);
+                if (changed && !inWork[nt]) {
+                    inWork[nt] = true;
+                    work.push_back(nt);
+                }
+            };
+            SymbolSet initial(T + 1);
+            initial.insert(dummy);
+            offer(x - T, restFirst[item], restNullable[item], initial);
+            while (!work.empty()) {
+                uint32_t nt = work.back();
+                work.pop_back();
+                inWork[nt] = false;
+                CDLAB_COUNT(Metric::LALR_CLOSURE_STEPS, 1);
+                for (uint32_t p : rulesOf[nt]) {
+                    uint32_t first = itemStart[p], y = itemNext[first];
+                    if (y != UINT32_MAX && isNonTerminal(y)) offer(y - T, restFirst[first], restNullable[first], la[nt]);
+                }
+            }
+
+            for (uint32_t nt : touched) {
+                for (uint32_t p : rulesOf[nt]) {
+                    uint32_t first = itemStart[p], y = itemNext[first];
+                    if (y != UINT32_MAX) {
+                        receive(from, kernelSlot(gotoOf[y], first + 1), la[nt]);
+                        continue;
+                    }
+                    if (epsilonStamp[p] != state) { // first time this ε-item shows up in the state
+                        epsilonStamp[p] = state;
+                        epsilonSlotOf[p] = lookahead.size();
+                        lookahead.emplace_back(T);
+                        propagate.emplace_back();
+                        epsilonSlots[state].push_back({p, epsilonSlotOf[p]});
+                    }
+                    receive(from, epsilonSlotOf[p], la[nt]);
+                }
+            }
+        }
+    }
+
+    // The augmented item S' -> .S sees the end marker; spread everything to a fixed point
+    lookahead[0].insert(Grammar::endMarker);
+    std::vector<uint32_t> slots;
+    std::vector<bool> slotQueued(lookahead.size(), true);
+    for (uint32_t slot = 0; slot < lookahead.size(); slot++) slots.push_back(slot);
+    while (!slots.empty()) {
+        uint32_t from = slots.back();
+        slots.pop_back();
+        slotQueued[from] = false;
+        CDLAB_COUNT(Metric::LALR_LOOKAHEAD_STEPS, 1);
+        for (uint32_t to : propagate[from]) {
+            if (lookahead[to].unite(lookahead[from]) && !slotQueued[to]) {
+                slotQueued[to] = true;
+                slots.push_back(to);
+            }
+        }
+    }
+
+    // ACTION and GOTO rows
+    LALRTable table;
+    table.stateCount = S;
+    table.accepting = P;
+    table.productionLength.resize(P + 1);
+    table.productionHead = head;
+    for (uint32_t p = 0; p <= P; p++) table.productionLength[p] = body[p].size();
+
+    std::vector<std::vector<std::pair<uint32_t, int32_t>>> actionRows(S), gotoRows(N);
+    std::vector<int32_t> actionDefaults(S, 0), gotoDefaults(N, 0);
+    std::vector<int32_t> row(T);
+    std::vector<uint32_t> reduceCount(P + 1, 0);
+    for (uint32_t state = 0; state < S; state++) {
+        std::fill(row.begin(), row.end(), 0);
+        for (const auto &edge : transitions[state]) {
+            if (isNonTerminal(edge.first)) {
+                gotoRows[edge.first - T].push_back({state, int32_t(edge.second + 1)});
+            } else {
+                row[edge.first] = edge.second + 1;
+            }
+        }
+
+        auto addReduce = [&](uint32_t p, const SymbolSet &on) {
+            on.forEach([&](uint32_t t) {
+                int32_t action = -int32_t(p + 1);
+                int32_t &cell = row[t];
+                if (cell == 0 || cell == action) {
+                    cell = action;
+                } else if (uint32_t(-cell - 1) == P || (p != P && (cell > 0 || -cell - 1 < int32_t(p)))) {
+                    // accept wins, then shift, then the earlier production
+                    table.conflicts.push_back({state, t, cell, action});
+                } else {
+                    table.conflicts.push_back({state, t, action, cell});
+                    cell = action;
+                }
+            });
+        };
+        for (uint32_t k = 0; k < kernels[state].size(); k++) {
+            uint32_t item = kernels[state][k];
+            if (itemNext[item] == UINT32_MAX) addReduce(itemProduction[item], lookahead[slotBase[state] + k]);
+        }
+        for (const auto &epsilon : epsilonSlots[state]) addReduce(epsilon.first, lookahead[epsilon.second]);
+
+        // The most frequent reduction becomes the row default (never accept)
+        int32_t best = 0;
+        uint32_t bestCount = 0;
+        for (int32_t cell : row) {
+            if (cell < 0 && uint32_t(-cell - 1) != P && ++reduceCount[-cell - 1] > bestCount) {
+                bestCount = reduceCount[-cell - 1];
+                best = cell;
+            }
+        }
+        for (int32_t cell : row)
+            if (cell < 0) reduceCount[-cell - 1] = 0;
+        actionDefaults[state] = best;
+        for (uint32_t t = 0; t < T; t++)
+            if (row[t] != 0 && row[t] != best) actionRows[state].push_back({t, row[t]});
+    }
+    std::unordered_map<int32_t, uint32_t> targetCount;
+    for (uint32_t nt = 0; nt < N; nt++) {
+        targetCount.clear();
+        uint32_t bestCount = 0;
+        for (const auto &entry : gotoRows[nt]) {
+            if (++targetCount[entry.second] > bestCount) {
+                bestCount = targetCount[entry.second];
+                gotoDefaults[nt] = entry.second;
+            }
+        }
+        auto &column = gotoRows[nt];
+        column.erase(std::remove_if(column.begin(), column.end(),
+                               [&](const std::pair<uint32_t, int32_t> &entry) { return entry.second == gotoDefaults[nt]; }),
+                     column.end());
+    }
+    table.action = packCombTable(actionRows, std::move(actionDefaults));
+    table.gotoTable = packCombTable(gotoRows, std::move(gotoDefaults));
+    return table;
+}
+
+// Function to parse a string of terminal symbol ids with the shift-reduce driver;
+// on success `reductions` lists the productions of a rightmost derivation in
+// reverse, on failure `errorPos` is the index of the offending token. A
+// conflicted table for a cyclic grammar (S -> A, A -> S) can reduce forever
+// without consuming input, so reductions between two shifts are capped.
+inline bool lalrParse(const Grammar &grammar, const LALRTable &table, const std::vector<uint32_t> &tokens,
+                      std::vector<uint32_t> *reductions = nullptr, size_t *errorPos = nullptr) {
+    std::vector<uint32_t> stack = {0};
+    size_t pos = 0;
+    size_t reductionsSinceShift = 0;
+
+    while (true) {
+        uint32_t token = pos < tokens.size() ? tokens[pos] : Grammar::endMarker;
+        if (grammar.isNonTerminal[token]) break;
+        int32_t action = table.action.lookup(stack.back(), grammar.index[token]);
+
+        if (action > 0) {
+            stack.push_back(action - 1);
+            pos++;
+            reductionsSinceShift = 0;
+        } else if (action < 0) {
+            uint32_t p = -action - 1;
+            if (p == table.accepting) return true;
+            // A generous cap: popping reductions shrink the stack, and without a
+            // cycle the unit and ε reductions between them stay under the production count
+            if (++reductionsSinceShift > (stack.size() + 1) * table.productionLength.size()) break;
+            stack.resize(stack.size() - table.productionLength[p]);
+            int32_t target = table.gotoTable.lookup(table.productionHead[p], stack.back());
+            if (target == 0) break; // only reachable through a default reduction on bad input
+            stack.push_back(target - 1);
+            if (reductions) reductions->push_back(p);
+        } else {
+            break;
+        }
+    }
+
+    if (errorPos) *errorPos = pos;
+    return false;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+#include <unordered_map>
+#include "grammar.h"
+
+// Function to left factor a whole grammar. Each nonterminal's productions go into a
+// trie of symbol ids; every trie node where alternatives diverge becomes a new
+// nonterminal A_factN, so nested common prefixes are factored too and the result
+// needs no further passes. Duplicate productions collapse into one. Runs in time
+// linear in the total size of the grammar.
+inline Grammar leftFactor(const Grammar &grammar) {
+    struct TrieNode {
+        uint32_t symbol;
+        uint32_t firstChild, lastChild, nextSibling; // 0 = none (the root is never a child)
+        bool ends;
+    };
+
+    Grammar result;
+    std::vector<uint32_t> remap = result.declareSymbolsOf(grammar);
+
+    std::vector<TrieNode> trie;
+    std::unordered_map<uint64_t, uint32_t> edges; // (node << 32 | symbol) -> child
+    std::vector<std::pair<uint32_t, uint32_t>> work;   // (head, trie node whose branches head derives)
+    int count = 1; // For creating new non-terminal names
+
+    for (uint32_t nt : grammar.nonTerminals) {
+        trie.assign(1, {0, 0, 0, 0, false});
+        edges.clear();
+        for (uint32_t number : grammar.rules[grammar.index[nt]]) {
+            uint32_t node = 0;
+            for (uint32_t symbol : grammar.productions[number].body) {
+                auto [it, inserted] = edges.try_emplace(uint64_t(node) << 32 | remap[symbol], trie.size());
+                if (inserted) {
+                    trie.push_back({remap[symbol], 0, 0, 0, false});
+                    uint32_t &link = trie[node].lastChild ? trie[trie[node].lastChild].nextSibling : trie[node].firstChild;
+                    link = it->second;
+                    trie[node].lastChild = it->second;
+                }
+                node = it->second;
+            }
+            trie[node].ends = true;
+        }
+
+        work.assign(1, {remap[nt], 0});
+        while (!work.empty()) {
+            auto [head, node] = work.back();
+            work.pop_back();
+            if (trie[node].ends) result.addProduction(head, {});
+
+            for (uint32_t child = trie[node].firstChild; child; child = trie[child].nextSibling) {
+                // Follow the chain while no alternative ends or diverges
+                std::vector<uint32_t> body = {trie[child].symbol};
+                uint32_t cur = child;
+                while (!trie[cur].ends && trie[cur].firstChild && trie[cur].firstChild == trie[cur].lastChild) {
+                    cur = trie[cur].firstChild;
+                    body.push_back(trie[cur].symbol);
+                }
+                if (trie[cur].firstChild) { // alternatives diverge after `body`
+                    uint32_t factored = result.addFreshNonTerminal(grammar.name(nt), "_fact", count);
+                    body.push_back(factored);
+                    work.push_back({factored, cur});
+                }
+                result.addProduction(head, std::move(body));
+            }
+        }
+    }
+    return result;
+}
+
+// Function to perform left factoring on the given grammar
+inline void leftFactorGrammar(std::map<std::string, std::vector<std::string>>& grammar) {
+    std::map<std::string, std::vector<std::string>> newGrammar = leftFactor(Grammar::fromRules(grammar)).toRules();
+
+    // Display the left-factored grammar
+    std::cout << "Left Factored Grammar:\n";
+    for (const auto& rule : newGrammar) {
+        std::cout << rule.first << " -> ";
+        for (size_t i = 0; i < rule.second.size(); i++) {
+            std::cout << rule.second[i];
+            if (i != rule.second.size() - 1) std::cout << " | ";
+        }
+        std::cout << std::endl;
+    }
+}
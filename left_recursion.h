@@ -0,0 +1,154 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include "grammar.h"
+
+// Function to group nonterminals into strongly connected components of the
+// left-corner graph (A -> B when some A-production starts with B); returns a
+// component id per nonterminal index. Iterative Tarjan.
+inline std::vector<uint32_t> leftCornerComponents(const Grammar &grammar) {
+    size_t n = grammar.nonTerminalCount();
+    std::vector<std::vector<uint32_t>> edges(n);
+    for (const Grammar::Production &production : grammar.productions) {
+        if (!production.body.empty() && grammar.isNonTerminal[production.body[0]])
+            edges[grammar.index[production.head]].push_back(grammar.index[production.body[0]]);
+    }
+
+    const uint32_t unvisited = UINT32_MAX;
+    std::vector<uint32_t> order(n, unvisited), low(n), component(n, unvisited), stack;
+    std::vector<std::pair<uint32_t, size_t>> frames; // (node, next edge)
+    uint32_t counter = 0, components = 0;
+    for (uint32_t root = 0; root < n; root++) {
+        if (order[root] != unvisited) continue;
+        frames.push_back({root, 0});
+        order[root] = low[root] = counter++;
+        stack.push_back(root);
+        while (!frames.empty()) {
+            auto &[node, next] = frames.back();
+            if (next < edges[node].size()) {
+                uint32_t to = edges[node][next++];
+                if (order[to] == unvisited) {
+                    order[to] = low[to] = counter++;
+                    stack.push_back(to);
+                    frames.push_back({to, 0});
+                } else if (component[to] == unvisited) {
+                    low[node] = std::min(low[node], order[to]);
+                }
+                continue;
+            }
+            uint32_t done = node;
+            frames.pop_back();
+            if (!frames.empty()) low[frames.back().first] = std::min(low[frames.back().first], low[done]);
+            if (low[done] == order[done]) {
+                uint32_t member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    component[member] = components;
+                } while (member != done);
+                components++;
+            }
+        }
+    }
+    return component;
+}
+
+// Function to eliminate direct and indirect left recursion from a whole grammar,
+// in nonterminal declaration order A1..An: every Ai -> Aj γ with j < i is replaced
+// by Aj's already-rewritten alternatives, then Ai's direct recursion is removed
+// with a new nonterminal Ai'. Substitution is limited to Aj in the same
+// left-corner cycle as Ai (Moore's refinement), since no other Aj can lead back
+// to Ai; this keeps acyclic parts of large grammars from blowing up. Only
+// productions that still lead with such a nonterminal are expanded, so nothing is
+// rescanned per substitution. As with the textbook algorithm, the language is
+// always preserved, but left recursion can survive if the input has
+// ε-productions or cycles (A =>+ A).
+inline Grammar eliminateLeftRecursion(const Grammar &grammar) {
+    Grammar result;
+    std::vector<uint32_t> remap = result.declareSymbolsOf(grammar);
+    size_t n = grammar.nonTerminalCount();
+    std::vector<uint32_t> component = leftCornerComponents(grammar);
+
+    std::vector<std::vector<std::vector<uint32_t>>> rewritten(n); // by nonterminal index, final alternatives
+    std::vector<std::pair<uint32_t, std::vector<std::vector<uint32_t>>>> primed; // new nonterminal and its alternatives
+    std::vector<std::vector<uint32_t>> pending, alpha, beta;
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t head = remap[grammar.nonTerminals[i]];
+        const std::vector<uint32_t> &numbers = grammar.rules[i];
+
+        // Substitute earlier nonterminals at the front until none is left there
+        pending.clear();
+        for (auto it = numbers.rbegin(); it != numbers.rend(); ++it) {
+            std::vector<uint32_t> body;
+            for (uint32_t symbol : grammar.productions[*it].body) body.push_back(remap[symbol]);
+            pending.push_back(std::move(body));
+        }
+        alpha.clear();
+        beta.clear();
+        while (!pending.empty()) {
+            std::vector<uint32_t> body = std::move(pending.back());
+            pending.pop_back();
+            uint32_t lead = body.empty() ? UINT32_MAX : body[0];
+            if (lead != UINT32_MAX && result.isNonTerminal[lead] && result.index[lead] < i &&
+                component[result.index[lead]] == component[i]) {
+                const std::vector<std::vector<uint32_t>> &alternatives = rewritten[result.index[lead]];
+                for (auto it = alternatives.rbegin(); it != alternatives.rend(); ++it) {
+                    std::vector<uint32_t> expanded = *it;
+                    expanded.insert(expanded.end(), body.begin() + 1, body.end());
+                    pending.push_back(std::move(expanded));
+                }
+            } else if (lead == head) {
+                if (body.size() > 1) alpha.emplace_back(body.begin() + 1, body.end()); // A -> A alone is dropped
+            } else {
+                beta.push_back(std::move(body));
+            }
+        }
+
+        if (alpha.empty()) {
+            rewritten[i] = std::move(beta);
+            continue;
+        }
+
+        // A -> β A' and A' -> α A' | ε
+        std::string name = std::string(result.name(head)) + "'";
+        while (result.find(name) != UINT32_MAX) name += "'";
+        uint32_t tail = result.addNonTerminal(name);
+        for (std::vector<uint32_t> &body : beta) body.push_back(tail);
+        for (std::vector<uint32_t> &body : alpha) body.push_back(tail);
+        alpha.emplace_back();
+        rewritten[i] = std::move(beta);
+        primed.push_back({tail, std::move(alpha)});
+        alpha.clear();
+        beta.clear();
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+        for (std::vector<uint32_t> &body : rewritten[i]) result.addProduction(remap[grammar.nonTerminals[i]], std::move(body));
+    for (auto &rule : primed)
+        for (std::vector<uint32_t> &body : rule.second) result.addProduction(rule.first, std::move(body));
+    return result;
+}
+
+// Function to eliminate left recursion
+inline void removeLeftRecursion(std::string nonTerminal, std::vector<std::string>& productions) {
+    Grammar converted = eliminateLeftRecursion(Grammar::fromRules({{nonTerminal, productions}}));
+
+    // If left recursion exists, print the transformed grammar
+    if (converted.nonTerminalCount() > 1) {
+        std::cout << "Converted Grammar:\n";
+        for (const auto& rule : converted.toRules()) {
+            std::cout << rule.first << " -> ";
+            for (size_t i = 0; i < rule.second.size(); i++) {
+                std::cout << rule.second[i];
+                if (i < rule.second.size() - 1) std::cout << " | ";
+            }
+            std::cout << std::endl;
+        }
+    } else {
+        std::cout << "No left recursion detected in " << nonTerminal << ".\n";
+    }
+}
@@ -0,0 +1,334 @@
+#pragma once
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <unordered_map>
+#include <string_view>
+#include <algorithm>
+#include <cctype>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <thread>
+#include "token_buffer.h"
+#include "perfect_hash.h"
+#include "metrics.h"
+class LexicalAnalyzer
+{
+public:
+    enum TokenType : uint8_t
+    {
+        KEYWORD,
+        IDENTIFIER,
+        OPERATOR,
+        LITERAL,
+        PUNCTUATION,
+        UNKNOWN
+    };
+
+private:
+    friend class IncrementalLexer; // reuses scan and identifyType
+
+    static constexpr std::string_view keywordList[] = {"int", "float", "char", "return", "if", "else", "while", "for"};
+    static constexpr std::string_view operatorList[] = {"+", "-", "*", "/", "=", "==", "!=", "<", ">", "<=", ">="};
+    static constexpr std::string_view punctuationList[] = {"(", ")", "{", "}", ";", ","};
+
+    static constexpr auto keywords = makePerfectHashSet(keywordList);
+    static constexpr auto operators = makePerfectHashSet(operatorList);
+    static constexpr auto punctuation = makePerfectHashSet(punctuationList);
+
+    TokenBuffer tokens;
+    SymbolTable symbols;
+    std::vector<TokenType> symbolTypes; // type of each interned symbol, classified once
+
+    // Hand-written forms of the patterns the lexer has always used:
+    //   identifier [a-zA-Z_][a-zA-Z0-9_]*   number [-+]?[0-9]*\.?[0-9]+
+    //   character  '.'                      string ".*"
+    // where . is any byte but a line terminator, as in std::regex.
+    static bool isLineTerminator(char c) { return c == '\n' || c == '\r'; }
+
+    static bool isIdentifierToken(std::string_view token)
+    {
+        if (token.empty() || !(isalpha((unsigned char)token[0]) || token[0] == '_'))
+            return false;
+        for (char c : token)
+            if (!(isalnum((unsigned char)c) || c == '_'))
+                return false;
+        return true;
+    }
+
+    static bool isNumberToken(std::string_view token)
+    {
+        if (!token.empty() && (token[0] == '-' || token[0] == '+'))
+            token.remove_prefix(1);
+        if (token.empty() || !isdigit((unsigned char)token.back()))
+            return false;
+        bool seenPoint = false;
+        for (char c : token)
+        {
+            if (c == '.' && !seenPoint)
+                seenPoint = true;
+            else if (!isdigit((unsigned char)c))
+                return false;
+        }
+        return true;
+    }
+
+    static bool isQuotedToken(std::string_view token)
+    {
+        if (token.size() == 3 && token[0] == '\'' && token[2] == '\'')
+            return !isLineTerminator(token[1]);
+        if (token.size() < 2 || token.front() != '"' || token.back() != '"')
+            return false;
+        return std::find_if(token.begin() + 1, token.end() - 1, isLineTerminator) == token.end() - 1;
+    }
+
+    static TokenType identifyType(std::string_view token)
+    {
+        if (keywords.contains(token))
+            return KEYWORD;
+        if (operators.contains(token))
+            return OPERATOR;
+        if (punctuation.contains(token))
+            return PUNCTUATION;
+        if (isIdentifierToken(token))
+            return IDENTIFIER;
+        if (isNumberToken(token) || isQuotedToken(token))
+            return LITERAL;
+        return UNKNOWN;
+    }
+
+    void addToken(std::string_view token, uint64_t offset, int lineNumber)
+    {
+        if (token.empty())
+            return;
+        uint32_t symbol = symbols.intern(token);
+        if (symbol == symbolTypes.size())
+            symbolTypes.push_back(identifyType(token));
+        tokens.push(symbolTypes[symbol], symbol, offset, token.size(), lineNumber);
+        CDLAB_COUNT(metricAt(Metric::LEXICAL_ANALYZER_TOKENS, symbolTypes[symbol]), 1);
+    }
+
+    static bool startsComment(std::string_view text, size_t i)
+    {
+        return text[i] == '/' && i + 1 < text.size() && text[i + 1] == '/';
+    }
+
+    // Splits text into whitespace-separated tokens, dropping // comments and
+    // counting lines. Unless isLast is set, a token or comment that runs into
+    // the end of text is left unscanned and its offset is returned so the
+    // caller can resume there with more input; otherwise returns text.size().
+    template <typename Visit>
+    static size_t scan(std::string_view text, bool isLast, int &lineNumber, Visit visit)
+    {
+        size_t i = 0, n = text.size();
+        while (i < n)
+        {
+            char c = text[i];
+            if (c == '\n')
+            {
+                lineNumber++;
+                i++;
+                continue;
+            }
+            if (isspace((unsigned char)c))
+            {
+                i++;
+                continue;
+            }
+
+            size_t start = i;
+            if (startsComment(text, i))
+            {
+                i = text.find('\n', i);
+                if (i == std::string_view::npos)
+                {
+                    if (!isLast)
+                        return start;
+                    i = n;
+                }
+                continue;
+            }
+
+            while (i < n && !isspace((unsigned char)text[i]) && !startsComment(text, i))
+                i++;
+            if (i == n && !isLast)
+                return start;
+            visit(text.substr(start, i - start), lineNumber);
+        }
+        return n;
+    }
+
+    // Returns the number of lines seen, counting a trailing partial line.
+    int tokenize(std::string_view input)
+    {
+        int lineNumber = 1;
+        CDLAB_STOPWATCH(phases); // scan: splitting; classify: interning and identifyType
+        scan(input, true, lineNumber, [&](std::string_view token, int line)
+             {
+                 CDLAB_LAP(phases, Metric::LEXICAL_ANALYZER_SCAN_SECONDS);
+                 addToken(token, token.data() - input.data(), line);
+                 CDLAB_LAP(phases, Metric::LEXICAL_ANALYZER_CLASSIFY_SECONDS);
+             });
+        CDLAB_LAP(phases, Metric::LEXICAL_ANALYZER_SCAN_SECONDS);
+        return lineNumber;
+    }
+
+public:
+    void analyze(const std::string &code)
+    {
+        tokens.clear();
+        symbols.clear();
+        symbolTypes.clear();
+        tokenize(code);
+    }
+
+    // Same result as analyze, with the input split at newline boundaries and
+    // the chunks lexed on separate threads. A chunk edge always falls at the
+    // start of a line, and no lexer state outlives a line here (comments are
+    // // only, tokens never contain whitespace), so every chunk can be lexed
+    // independently and no re-lexing is needed. The per-chunk buffers are
+    // stitched in order, which reproduces serial offsets, line numbers and
+    // symbol ids exactly.
+    void analyzeParallel(const std::string &code, int threadCount = 0)
+    {
+        if (threadCount <= 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        std::vector<size_t> bounds = {0};
+        for (int t = 1; t < threadCount; t++)
+        {
+            size_t newline = code.find('\n', std::max(bounds.back(), code.size() * t / threadCount));
+            if (newline == std::string::npos)
+                break;
+            if (newline + 1 > bounds.back())
+                bounds.push_back(newline + 1);
+        }
+        bounds.push_back(code.size());
+
+        int chunkCount = bounds.size() - 1;
+        std::vector<LexicalAnalyzer> chunks(chunkCount);
+        std::vector<int> lineCounts(chunkCount);
+        std::vector<std::thread> workers;
+        for (int c = 0; c < chunkCount; c++)
+        {
+            workers.emplace_back([&, c]()
+                                 { lineCounts[c] = chunks[c].tokenize(std::string_view(code).substr(bounds[c], bounds[c + 1] - bounds[c])); });
+        }
+        for (std::thread &w : workers)
+            w.join();
+
+        tokens.clear();
+        symbols.clear();
+        symbolTypes.clear();
+        size_t total = 0;
+        for (const auto &chunk : chunks)
+            total += chunk.tokens.size();
+        tokens.reserve(total);
+
+        uint32_t lineBase = 0;
+        std::vector<uint32_t> globalId;
+        for (int c = 0; c < chunkCount; c++)
+        {
+            const LexicalAnalyzer &chunk = chunks[c];
+            // Local ids are in first-occurrence order, so interning them in
+            // order yields the ids a serial pass would have assigned.
+            globalId.resize(chunk.symbols.size());
+            for (uint32_t local = 0; local < chunk.symbols.size(); local++)
+            {
+                globalId[local] = symbols.intern(chunk.symbols.name(local));
+                if (globalId[local] == symbolTypes.size())
+                    symbolTypes.push_back(chunk.symbolTypes[local]);
+            }
+
+            // Chunk offsets are rebased in 64 bits, so chunks past 4 GiB keep exact offsets
+            const TokenBuffer &local = chunk.tokens;
+            uint64_t offsetBase = bounds[c];
+            for (size_t i = 0; i < local.size(); i++)
+                tokens.push(local.kinds[i], globalId[local.symbols[i]], offsetBase + local.offsets[i],
+                            local.lengths[i], local.lines[i] + lineBase);
+            lineBase += lineCounts[c] - 1;
+        }
+    }
+
+    // Lexes a file in place through a read-only mapping that slides over it
+    // one window at a time, so memory use does not grow with the file size.
+    // visit(string_view value, TokenType type, int lineNumber) is called for
+    // every token; the view points into the mapping and is only valid during
+    // the call. Returns false if the file cannot be opened or mapped.
+    template <typename Visit>
+    bool analyzeMapped(const std::string &path, Visit visit, size_t windowSize = 64 << 20)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) < 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        size_t size = info.st_size;
+        size_t page = sysconf(_SC_PAGESIZE);
+        windowSize = std::max(page, (windowSize + page - 1) / page * page);
+
+        size_t pos = 0;
+        int lineNumber = 1;
+        CDLAB_STOPWATCH(phases); // the visitor's own time is left out
+        while (pos < size)
+        {
+            size_t mapStart = pos - pos % page;
+            size_t length = std::min(windowSize, size - mapStart);
+            void *base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, mapStart);
+            if (base == MAP_FAILED)
+            {
+                close(fd);
+                return false;
+            }
+            madvise(base, length, MADV_SEQUENTIAL);
+
+            bool isLast = mapStart + length == size;
+            std::string_view text((const char *)base + (pos - mapStart), length - (pos - mapStart));
+            size_t consumed = scan(text, isLast, lineNumber, [&](std::string_view token, int line)
+                                   {
+                                       CDLAB_LAP(phases, Metric::LEXICAL_ANALYZER_SCAN_SECONDS);
+                                       TokenType type = identifyType(token);
+                                       CDLAB_COUNT(metricAt(Metric::LEXICAL_ANALYZER_TOKENS, type), 1);
+                                       CDLAB_LAP(phases, Metric::LEXICAL_ANALYZER_CLASSIFY_SECONDS);
+                                       visit(token, type, line);
+                                       CDLAB_RESTART(phases);
+                                   });
+            munmap(base, length);
+
+            if (consumed == 0 && !isLast)
+                windowSize *= 2; // a single token is longer than the window
+            pos += consumed;
+        }
+
+        close(fd);
+        CDLAB_LAP(phases, Metric::LEXICAL_ANALYZER_SCAN_SECONDS);
+        return true;
+    }
+
+    const TokenBuffer &tokenBuffer() const { return tokens; }
+    const SymbolTable &symbolTable() const { return symbols; }
+
+    static const char *typeName(TokenType type)
+    {
+        return type == KEYWORD ? "Keyword" : type == IDENTIFIER ? "Identifier"
+                                         : type == OPERATOR     ? "Operator"
+                                         : type == LITERAL      ? "Literal"
+                                         : type == PUNCTUATION  ? "Punctuation"
+                                                                : "Unknown";
+    }
+
+    void printTokens()
+    {
+        for (size_t i = 0; i < tokens.size(); i++)
+            std::cout << "Line " << tokens.lines[i] << " | " << symbols.name(tokens.symbols[i]) << " | "
+                 << typeName(TokenType(tokens.kinds[i])) << std::endl;
+    }
+};
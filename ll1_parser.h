@@ -0,0 +1,90 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "grammar.h"
+
+// Two productions competing for the same table cell.
+struct LL1Conflict {
+    uint32_t nonTerminal, terminal; // dense indexes
+    uint32_t existing, incoming;    // production numbers
+};
+
+// LL(1) parse table built from FIRST/FOLLOW. Cells live in one dense array
+// indexed by (nonterminal index, terminal index), holding a production number
+// or -1; column 0 is the end marker "$".
+struct LL1Table {
+    size_t columns = 0;
+    std::vector<int32_t> cells;
+    std::vector<LL1Conflict> conflicts;
+
+    int32_t &cell(uint32_t nonTerminal, uint32_t terminal) { return cells[nonTerminal * columns + terminal]; }
+    int32_t cell(uint32_t nonTerminal, uint32_t terminal) const { return cells[nonTerminal * columns + terminal]; }
+    bool isLL1() const { return conflicts.empty(); }
+};
+
+// Function to build the LL(1) table: production A -> α goes in M[A, a] for every
+// a in FIRST(α), and for every a in FOLLOW(A) when α is nullable
+inline LL1Table buildLL1Table(const Grammar &grammar, const FirstFollowSets &sets) {
+    LL1Table table;
+    table.columns = grammar.terminalCount();
+    table.cells.assign(grammar.nonTerminalCount() * table.columns, -1);
+
+    SymbolSet lookahead(grammar.terminalCount());
+    for (uint32_t number = 0; number < grammar.productions.size(); number++) {
+        const Grammar::Production &production = grammar.productions[number];
+        uint32_t row = grammar.index[production.head];
+        std::fill(lookahead.words.begin(), lookahead.words.end(), 0);
+        const uint32_t *body = production.body.data();
+        if (firstOfSequence(grammar, sets, body, body + production.body.size(), lookahead)) lookahead.unite(sets.follow[row]);
+
+        lookahead.forEach([&](uint32_t column) {
+            int32_t &entry = table.cell(row, column);
+            if (entry >= 0) {
+                table.conflicts.push_back({row, column, uint32_t(entry), number});
+            } else {
+                entry = number;
+            }
+        });
+    }
+    return table;
+}
+
+// Function to parse a string of terminal symbol ids with an explicit stack; on success
+// `derivation` holds the leftmost derivation as production numbers, on failure
+// `errorPos` is the index of the offending token. A table with conflicts is
+// refused, since a left-recursive cell (E -> E+i) would grow the stack forever,
+// and expansions between two matched tokens are capped as a backstop.
+inline bool predictiveParse(const Grammar &grammar, const LL1Table &table, const std::vector<uint32_t> &tokens,
+                            std::vector<uint32_t> *derivation = nullptr, size_t *errorPos = nullptr) {
+    std::vector<uint32_t> stack = {Grammar::endMarker, grammar.start};
+    size_t pos = 0;
+    size_t expansionsSinceMatch = 0;
+
+    while (table.isLL1()) {
+        uint32_t top = stack.back();
+        uint32_t current = pos < tokens.size() ? tokens[pos] : Grammar::endMarker;
+
+        if (!grammar.isNonTerminal[top]) { // terminal or "$" on top: must match the input
+            if (top != current) break;
+            if (top == Grammar::endMarker) return true;
+            stack.pop_back();
+            pos++;
+            expansionsSinceMatch = 0;
+            continue;
+        }
+
+        int32_t number = grammar.isNonTerminal[current] ? -1 : table.cell(grammar.index[top], grammar.index[current]);
+        if (number < 0) break;
+        if (++expansionsSinceMatch > (stack.size() + 1) * grammar.nonTerminalCount()) break;
+
+        stack.pop_back();
+        const std::vector<uint32_t> &body = grammar.productions[number].body;
+        stack.insert(stack.end(), body.rbegin(), body.rend());
+        if (derivation) derivation->push_back(number);
+    }
+
+    if (errorPos) *errorPos = pos;
+    return false;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cctype>
+#include "dfa.h"
+
+enum class MatcherStyle
+{
+    SWITCH, // one label per state, a switch on the next byte, goto to the target
+    TABLE,  // constexpr byte-class and transition arrays with narrow cell types
+};
+
+// Writes a self-contained header defining `bool name(std::string_view)` that
+// accepts exactly the inputs dfa.matches() accepts. The switch style only
+// emits states reachable from the start state and puts each state's most
+// common target (usually the dead state) in the default label. The table
+// style's matcher is constexpr, so it also works in static_assert.
+inline void writeMatcher(const CompiledDFA &dfa, const std::string &name, MatcherStyle style, std::ostream &out)
+{
+    out << "// Generated by writeMatcher (" << (style == MatcherStyle::SWITCH ? "switch" : "table") << " style, "
+        << dfa.stateCount - 1 << " states). Do not edit.\n"
+        << "#pragma once\n\n#include <cstdint>\n#include <string_view>\n\n";
+
+    if (style == MatcherStyle::TABLE)
+    {
+        const char *cell = dfa.stateCount <= 256 ? "std::uint8_t" : dfa.stateCount <= 65536 ? "std::uint16_t" : "std::uint32_t";
+        auto writeArray = [&](const char *type, const char *array, size_t size, auto value)
+        {
+            out << "inline constexpr " << type << " " << array << "[" << size << "] = {";
+            for (size_t i = 0; i < size; i++)
+                out << (i % 16 ? " " : "\n    ") << value(i) << ",";
+            out << "\n};\n";
+        };
+        out << "namespace " << name << "Tables\n{\n";
+        writeArray("std::uint8_t", "byteClass", 256, [&](size_t b) { return int(dfa.byteClass[b]); });
+        writeArray(cell, "next", dfa.table.size(), [&](size_t i) { return dfa.table[i]; });
+        writeArray("bool", "accepting", dfa.stateCount, [&](size_t s) { return dfa.isAccepting(s) ? "true" : "false"; });
+        out << "} // namespace " << name << "Tables\n\n"
+            << "constexpr bool " << name << "(std::string_view input)\n{\n"
+            << "    std::uint32_t state = " << dfa.startState << ";\n"
+            << "    for (char c : input)\n    {\n"
+            << "        state = " << name << "Tables::next[state * " << dfa.classCount << " + " << name
+            << "Tables::byteClass[(unsigned char)c]];\n"
+            << "        if (state == 0)\n            return false;\n    }\n"
+            << "    return " << name << "Tables::accepting[state];\n}\n";
+        return;
+    }
+
+    // Switch style: only live, reachable states get a block, and only jump
+    // targets a label (the start block is entered by falling through)
+    std::vector<int> order, label(dfa.stateCount, -1);
+    std::vector<bool> targeted(dfa.stateCount, false);
+    if (dfa.startState != CompiledDFA::DEAD)
+    {
+        order.push_back(dfa.startState);
+        label[dfa.startState] = 0;
+    }
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        for (int c = 0; c < dfa.classCount; c++)
+        {
+            int to = dfa.table[order[i] * dfa.classCount + c];
+            targeted[to] = true;
+            if (to != CompiledDFA::DEAD && label[to] < 0)
+            {
+                label[to] = order.size();
+                order.push_back(to);
+            }
+        }
+    }
+
+    auto byteLiteral = [](int b)
+    {
+        if (b < 128 && isalnum(b))
+            return "'" + std::string(1, char(b)) + "'";
+        return std::to_string(b);
+    };
+
+    out << "inline bool " << name << "(std::string_view input)\n{\n";
+    if (order.empty())
+    {
+        out << "    (void)input;\n    return false;\n}\n";
+        return;
+    }
+    out << "    const unsigned char *p = (const unsigned char *)input.data(), *end = p + input.size();\n";
+    std::vector<std::vector<int>> bytesTo(dfa.stateCount);
+    for (int state : order)
+    {
+        for (auto &bytes : bytesTo)
+            bytes.clear();
+        for (int b = 0; b < 256; b++)
+            bytesTo[dfa.step(state, b)].push_back(b);
+        int fallback = CompiledDFA::DEAD;
+        for (int to = 0; to < dfa.stateCount; to++)
+            if (bytesTo[to].size() > bytesTo[fallback].size())
+                fallback = to;
+
+        if (targeted[state])
+            out << "s" << label[state] << ":\n";
+        out << "    if (p == end)\n        return " << (dfa.isAccepting(state) ? "true" : "false") << ";\n"
+            << "    switch (*p++)\n    {\n";
+        for (int to = 0; to < dfa.stateCount; to++)
+        {
+            if (to == fallback || bytesTo[to].empty())
+                continue;
+            out << "   ";
+            for (int b : bytesTo[to])
+                out << " case " << byteLiteral(b) << ":";
+            out << (to == CompiledDFA::DEAD ? "\n        return false;\n" : "\n        goto s" + std::to_string(label[to]) + ";\n");
+        }
+        out << "    default:\n"
+            << (fallback == CompiledDFA::DEAD ? std::string("        return false;\n") : "        goto s" + std::to_string(label[fallback]) + ";\n")
+            << "    }\n";
+    }
+    out << "}\n";
+}
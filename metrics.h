@@ -0,0 +1,343 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+// Opt-in hot-path instrumentation. The CDLAB_* macros at the bottom are what
+// the automata, lexers and grammar passes call; unless CDLAB_METRICS is
+// defined (cmake -DCDLAB_METRICS=ON) they expand to an unevaluated sizeof, so
+// the arguments are type-checked but no code is generated.
+
+enum class Metric : uint16_t
+{
+    SUBSET_STATES,
+    SUBSET_TRANSITIONS,
+    SUBSET_PEAK_SIZE,
+    SUBSET_SECONDS,
+    DFA_MATCHES,
+    DFA_BYTES,
+    DFA_DEAD_EXITS,
+
+    TOKEN_ANALYZER_SCAN_SECONDS,
+    TOKEN_ANALYZER_CLASSIFY_SECONDS,
+    LEXICAL_ANALYZER_SCAN_SECONDS,
+    LEXICAL_ANALYZER_CLASSIFY_SECONDS,
+    TOKEN_ANALYZER_TOKENS,                          // one per TokenAnalyzer::Category
+    LEXICAL_ANALYZER_TOKENS = TOKEN_ANALYZER_TOKENS + 7, // one per LexicalAnalyzer::TokenType
+
+    NULLABLE_STEPS = LEXICAL_ANALYZER_TOKENS + 6,
+    FIRST_STEPS,
+    FOLLOW_STEPS,
+    LALR_CLOSURE_STEPS,
+    LALR_LOOKAHEAD_STEPS,
+    FIRST_FOLLOW_SECONDS,
+    LALR_SECONDS,
+
+    COUNT
+};
+
+// The metric `offset` places after `first`, for the per-category ranges.
+constexpr Metric metricAt(Metric first, int offset)
+{
+    return Metric(int(first) + offset);
+}
+
+struct MetricInfo
+{
+    enum Kind : uint8_t
+    {
+        COUNTER, // summed over threads
+        MAXIMUM, // largest value any thread recorded
+        TIMER,   // nanoseconds, summed over threads, exported in seconds
+    };
+
+    const char *name; // Prometheus family; rows sharing a family are adjacent
+    const char *labels;
+    Kind kind;
+    const char *help;
+};
+
+// In Metric order. Rates such as tokens per second are left to the reader:
+// cdlab_lexer_tokens_total over cdlab_lexer_seconds_total.
+inline constexpr MetricInfo metricInfo[] = {
+    {"cdlab_subset_states_total", "", MetricInfo::COUNTER, "DFA states discovered by subset construction"},
+    {"cdlab_subset_transitions_total", "", MetricInfo::COUNTER, "DFA transitions built by subset construction"},
+    {"cdlab_subset_peak_size", "", MetricInfo::MAXIMUM, "Most NFA states in one DFA state"},
+    {"cdlab_subset_seconds_total", "", MetricInfo::TIMER, "Time spent in subset construction"},
+    {"cdlab_dfa_matches_total", "", MetricInfo::COUNTER, "Inputs run through a DFA"},
+    {"cdlab_dfa_bytes_total", "", MetricInfo::COUNTER, "Input bytes consumed by DFA matching"},
+    {"cdlab_dfa_dead_exits_total", "", MetricInfo::COUNTER, "Matches rejected early by reaching the dead state"},
+
+    {"cdlab_lexer_seconds_total", "lexer=\"token_analyzer\",phase=\"scan\"", MetricInfo::TIMER, "Time spent lexing, by phase"},
+    {"cdlab_lexer_seconds_total", "lexer=\"token_analyzer\",phase=\"classify\"", MetricInfo::TIMER, ""},
+    {"cdlab_lexer_seconds_total", "lexer=\"lexical_analyzer\",phase=\"scan\"", MetricInfo::TIMER, ""},
+    {"cdlab_lexer_seconds_total", "lexer=\"lexical_analyzer\",phase=\"classify\"", MetricInfo::TIMER, ""},
+    {"cdlab_lexer_tokens_total", "lexer=\"token_analyzer\",category=\"keyword\"", MetricInfo::COUNTER, "Tokens produced, by category"},
+    {"cdlab_lexer_tokens_total", "lexer=\"token_analyzer\",category=\"operator\"", MetricInfo::COUNTER, ""},
+    {"cdlab_lexer_tokens_total", "lexer=\"token_analyzer\",category=\"punctuation\"", MetricInfo::COUNTER, ""},
+    {"cdlab_lexer_tokens_total", "lexer=\"token_analyzer\",category=\"identifier\"", MetricInfo::COUNTER, ""},
+    {"cdlab_lexer_tokens_total", "lexer=\"token_analyzer\",category=\"numeric_literal\"", MetricInfo::COUNTER, ""},
+    {"cdlab_lexer_tokens_total", "lexer=\"token_analyzer\",category=\"string_literal\"", MetricInfo::COUNTER, ""},
+    {"cdlab_lexer_tokens_total", "lexer=\"token_analyzer\",category=\"unknown\"", MetricInfo::COUNTER, ""},
+    {"cdlab_lexer_tokens_total", "lexer=\"lexical_analyzer\",category=\"keyword\"", MetricInfo::COUNTER, ""},
+    {"cdlab_lexer_tokens_total", "lexer=\"lexical_analyzer\",category=\"identifier\"", MetricInfo::COUNTER, ""},
+    {"cdlab_lexer_tokens_total", "lexer=\"lexical_analyzer\",category=\"operator\"", MetricInfo::COUNTER, ""},
+    {"cdlab_lexer_tokens_total", "lexer=\"lexical_analyzer\",category=\"literal\"", MetricInfo::COUNTER, ""},
+    {"cdlab_lexer_tokens_total", "lexer=\"lexical_analyzer\",category=\"punctuation\"", MetricInfo::COUNTER, ""},
+    {"cdlab_lexer_tokens_total", "lexer=\"lexical_analyzer\",category=\"unknown\"", MetricInfo::COUNTER, ""},
+
+    {"cdlab_grammar_fixpoint_steps_total", "pass=\"nullable\"", MetricInfo::COUNTER, "Worklist items processed before a grammar pass reached its fixed point"},
+    {"cdlab_grammar_fixpoint_steps_total", "pass=\"first\"", MetricInfo::COUNTER, ""},
+    {"cdlab_grammar_fixpoint_steps_total", "pass=\"follow\"", MetricInfo::COUNTER, ""},
+    {"cdlab_grammar_fixpoint_steps_total", "pass=\"lalr_closure\"", MetricInfo::COUNTER, ""},
+    {"cdlab_grammar_fixpoint_steps_total", "pass=\"lalr_lookahead\"", MetricInfo::COUNTER, ""},
+    {"cdlab_grammar_seconds_total", "pass=\"first_follow\"", MetricInfo::TIMER, "Time spent in grammar passes"},
+    {"cdlab_grammar_seconds_total", "pass=\"lalr\"", MetricInfo::TIMER, ""},
+};
+static_assert(std::size(metricInfo) == size_t(Metric::COUNT), "metricInfo must have one row per Metric");
+
+// Process-wide metrics. Each thread writes only its own block of relaxed
+// atomics, so recording is a plain load and store with no locked
+// instruction. Blocks sit on a lock-free list and are never freed: a thread
+// that exits hands its block, values included, to the next thread that
+// starts recording, and snapshot() folds every block it finds on the list.
+class Metrics
+{
+public:
+    static void add(Metric metric, uint64_t amount)
+    {
+        std::atomic<uint64_t> &value = local().values[size_t(metric)];
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static void recordMax(Metric metric, uint64_t amount)
+    {
+        std::atomic<uint64_t> &value = local().values[size_t(metric)];
+        if (amount > value.load(std::memory_order_relaxed))
+            value.store(amount, std::memory_order_relaxed);
+    }
+
+    // Totals over every thread that has recorded anything, by Metric.
+    static std::vector<uint64_t> snapshot()
+    {
+        std::vector<uint64_t> totals(size_t(Metric::COUNT), 0);
+        for (Block *block = head().load(std::memory_order_acquire); block; block = block->next)
+        {
+            for (size_t m = 0; m < totals.size(); m++)
+            {
+                uint64_t value = block->values[m].load(std::memory_order_relaxed);
+                totals[m] = metricInfo[m].kind == MetricInfo::MAXIMUM ? std::max(totals[m], value) : totals[m] + value;
+            }
+        }
+        return totals;
+    }
+
+    // Zeroes every block. Increments racing with the reset may be lost.
+    static void reset()
+    {
+        for (Block *block = head().load(std::memory_order_acquire); block; block = block->next)
+            for (std::atomic<uint64_t> &value : block->values)
+                value.store(0, std::memory_order_relaxed);
+    }
+
+    static void writeJSON(std::ostream &out)
+    {
+        std::vector<uint64_t> totals = snapshot();
+        out << "{\n  \"metrics\": [";
+        for (size_t m = 0; m < totals.size(); m++)
+        {
+            const MetricInfo &info = metricInfo[m];
+            out << (m ? "," : "") << "\n    {\"name\": \"" << info.name << "\", \"labels\": {";
+            // k="v",k="v" becomes "k": "v", "k": "v"; values never contain quotes or commas
+            for (const char *c = info.labels; *c; c++)
+            {
+                if (c == info.labels || c[-1] == ',')
+                    out << '"';
+                out << (*c == '=' ? "\": " : *c == ',' ? ", " : std::string(1, *c));
+            }
+            out << "}, \"value\": " << exported(info, totals[m]) << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    // Prometheus text exposition format, version 0.0.4.
+    static void writePrometheus(std::ostream &out)
+    {
+        std::vector<uint64_t> totals = snapshot();
+        for (size_t m = 0; m < totals.size(); m++)
+        {
+            const MetricInfo &info = metricInfo[m];
+            if (m == 0 || std::string(info.name) != metricInfo[m - 1].name)
+            {
+                out << "# HELP " << info.name << " " << info.help << "\n"
+                    << "# TYPE " << info.name << " " << (info.kind == MetricInfo::MAXIMUM ? "gauge" : "counter") << "\n";
+            }
+            out << info.name;
+            if (*info.labels)
+                out << "{" << info.labels << "}";
+            out << " " << exported(info, totals[m]) << "\n";
+        }
+    }
+
+    // Writes JSON if `path` ends in .json and Prometheus text otherwise. The
+    // file is renamed into place, so a collector never reads a partial one.
+    static bool writeFile(const std::string &path)
+    {
+        std::ostringstream text;
+        bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+        if (json)
+            writeJSON(text);
+        else
+            writePrometheus(text);
+
+        std::string temporary = path + ".tmp" + std::to_string(getpid());
+        {
+            std::ofstream out(temporary, std::ios::trunc);
+            if (!(out << text.str()) || !out.flush())
+            {
+                remove(temporary.c_str());
+                return false;
+            }
+        }
+        if (rename(temporary.c_str(), path.c_str()) != 0)
+        {
+            remove(temporary.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Writes the metrics to $CDLAB_METRICS_FILE, if set, when the process
+    // exits. Instrumented builds register this once at startup.
+    static bool exportAtExit()
+    {
+        return atexit([]()
+                      {
+                          const char *path = getenv("CDLAB_METRICS_FILE");
+                          if (path && *path && !writeFile(path))
+                              std::cerr << "Cannot write metrics to " << path << std::endl;
+                      }) == 0;
+    }
+
+private:
+    struct Block
+    {
+        std::array<std::atomic<uint64_t>, size_t(Metric::COUNT)> values{};
+        Block *next = nullptr;
+        std::atomic<bool> inUse{true};
+    };
+
+    // Owns the calling thread's block for the thread's lifetime.
+    struct Claim
+    {
+        Block *block;
+
+        Claim()
+        {
+            for (block = head().load(std::memory_order_acquire); block; block = block->next)
+            {
+                bool free = false;
+                if (!block->inUse.load(std::memory_order_relaxed) && block->inUse.compare_exchange_strong(free, true, std::memory_order_acquire))
+                    return;
+            }
+            block = new Block();
+            block->next = head().load(std::memory_order_relaxed);
+            while (!head().compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        ~Claim() { block->inUse.store(false, std::memory_order_release); }
+    };
+
+    static std::atomic<Block *> &head()
+    {
+        static std::atomic<Block *> list{nullptr};
+        return list;
+    }
+
+    static Block &local()
+    {
+        thread_local Claim claim;
+        return *claim.block;
+    }
+
+    static std::string exported(const MetricInfo &info, uint64_t value)
+    {
+        if (info.kind != MetricInfo::TIMER)
+            return std::to_string(value);
+        char seconds[32];
+        snprintf(seconds, sizeof seconds, "%.9f", value / 1e9);
+        return seconds;
+    }
+};
+
+// Adds the time between construction and destruction to a TIMER metric.
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Metric metric) : metric(metric), start(std::chrono::steady_clock::now()) {}
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    ~ScopedTimer()
+    {
+        Metrics::add(metric, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+private:
+    Metric metric;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Splits a loop's time between phases: lap(m) charges the time since the
+// previous lap (or construction) to m, at one clock read per lap.
+class Stopwatch
+{
+public:
+    Stopwatch() : last(std::chrono::steady_clock::now()) {}
+
+    void lap(Metric metric)
+    {
+        auto now = std::chrono::steady_clock::now();
+        Metrics::add(metric, std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count());
+        last = now;
+    }
+
+    // Starts the next lap now, leaving the time since the last one uncharged.
+    void restart() { last = std::chrono::steady_clock::now(); }
+
+private:
+    std::chrono::steady_clock::time_point last;
+};
+
+#define CDLAB_CONCAT_(a, b) a##b
+#define CDLAB_CONCAT(a, b) CDLAB_CONCAT_(a, b)
+
+#ifdef CDLAB_METRICS
+inline const bool cdlabMetricsExportRegistered = Metrics::exportAtExit();
+
+#define CDLAB_COUNT(metric, amount) Metrics::add(metric, amount)
+#define CDLAB_RECORD_MAX(metric, amount) Metrics::recordMax(metric, amount)
+#define CDLAB_TIME_SCOPE(metric) ScopedTimer CDLAB_CONCAT(cdlabTimer, __LINE__)(metric)
+#define CDLAB_STOPWATCH(name) Stopwatch name
+#define CDLAB_LAP(name, metric) name.lap(metric)
+#define CDLAB_RESTART(name) name.restart()
+#else
+#define CDLAB_COUNT(metric, amount) ((void)sizeof(metric), (void)sizeof(amount))
+#define CDLAB_RECORD_MAX(metric, amount) ((void)sizeof(metric), (void)sizeof(amount))
+#define CDLAB_TIME_SCOPE(metric) ((void)sizeof(metric))
+#define CDLAB_STOPWATCH(name) ((void)0)
+#define CDLAB_LAP(name, metric) ((void)sizeof(metric))
+#define CDLAB_RESTART(name) ((void)0)
+#endif
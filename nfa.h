@@ -0,0 +1,982 @@
+#pragma once
+
+#include <iostream>
+#include <set>
+#include <map>
+#include <queue>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+#include <string_view>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include "dfa.h"
+
+class NFA
+{
+public:
+    std::map<int, std::map<char, std::set<int>>> transition;
+    int startState;
+    std::set<int> acceptStates;
+
+    void addTransition(int from, char symbol, int to)
+    {
+        transition[from][symbol].insert(to);
+    }
+};
+
+class SubsetDFA
+{
+public:
+    std::map<std::set<int>, std::map<char, std::set<int>>> transition;
+    std::set<std::set<int>> acceptStates;
+};
+
+inline SubsetDFA convertNFAtoDFA(NFA nfa, std::set<int> /* states */, std::set<char> alphabet)
+{
+    CDLAB_TIME_SCOPE(Metric::SUBSET_SECONDS);
+    SubsetDFA dfa;
+    std::queue<std::set<int>> q;
+    std::set<std::set<int>> dfaStates;
+
+    q.push({nfa.startState});
+    dfaStates.insert({nfa.startState});
+    CDLAB_COUNT(Metric::SUBSET_STATES, 1);
+    CDLAB_RECORD_MAX(Metric::SUBSET_PEAK_SIZE, 1);
+
+    while (!q.empty())
+    {
+        std::set<int> current = q.front();
+        q.pop();
+
+        for (char symbol : alphabet)
+        {
+            std::set<int> newState;
+            for (int state : current)
+            {
+                if (nfa.transition.count(state) && nfa.transition[state].count(symbol))
+                {
+                    newState.insert(nfa.transition[state][symbol].begin(), nfa.transition[state][symbol].end());
+                }
+            }
+
+            if (!newState.empty() && dfaStates.find(newState) == dfaStates.end())
+            {
+                dfaStates.insert(newState);
+                q.push(newState);
+                CDLAB_COUNT(Metric::SUBSET_STATES, 1);
+                CDLAB_RECORD_MAX(Metric::SUBSET_PEAK_SIZE, newState.size());
+            }
+            CDLAB_COUNT(Metric::SUBSET_TRANSITIONS, !newState.empty());
+            dfa.transition[current][symbol] = newState;
+        }
+    }
+
+    for (std::set<int> stateSet : dfaStates)
+    {
+        for (int state : stateSet)
+        {
+            if (nfa.acceptStates.count(state))
+            {
+                dfa.acceptStates.insert(stateSet);
+                break;
+            }
+        }
+    }
+
+    return dfa;
+}
+
+// Fixed-size bitset over NFA state ids; used as the key for DFA states.
+class StateSet
+{
+public:
+    std::vector<uint64_t> words;
+
+    StateSet() {}
+    explicit StateSet(int stateCount) : words((stateCount + 63) / 64, 0) {}
+
+    void insert(int state) { words[state >> 6] |= uint64_t(1) << (state & 63); }
+    bool contains(int state) const { return (words[state >> 6] >> (state & 63)) & 1; }
+
+    void unite(const StateSet &other)
+    {
+        for (size_t i = 0; i < words.size(); i++)
+            words[i] |= other.words[i];
+    }
+
+    bool intersects(const StateSet &other) const
+    {
+        for (size_t i = 0; i < words.size(); i++)
+            if (words[i] & other.words[i])
+                return true;
+        return false;
+    }
+
+    bool empty() const
+    {
+        for (uint64_t w : words)
+            if (w)
+                return false;
+        return true;
+    }
+
+    int count() const
+    {
+        int n = 0;
+        for (uint64_t w : words)
+            n += __builtin_popcountll(w);
+        return n;
+    }
+
+    void clear() { std::fill(words.begin(), words.end(), 0); }
+
+    template <typename Visit>
+    void forEach(Visit visit) const
+    {
+        for (size_t i = 0; i < words.size(); i++)
+            for (uint64_t w = words[i]; w; w &= w - 1)
+                visit(int(i * 64 + __builtin_ctzll(w)));
+    }
+
+    bool operator==(const StateSet &other) const { return words == other.words; }
+};
+
+struct StateSetHash
+{
+    size_t operator()(const StateSet &s) const
+    {
+        uint64_t h = 1469598103934665603ull;
+        for (uint64_t w : s.words)
+        {
+            h ^= w;
+            h *= 1099511628211ull;
+            h ^= h >> 29;
+        }
+        return h;
+    }
+};
+
+// NFA with dense state ids 0..stateCount()-1 and epsilon transitions.
+class IndexedNFA
+{
+public:
+    int startState = 0;
+    std::vector<std::vector<std::pair<char, int>>> edges;
+    std::vector<std::vector<int>> epsilon;
+    std::vector<bool> accepting;
+
+    int stateCount() const { return accepting.size(); }
+
+    int addState(bool accept = false)
+    {
+        edges.emplace_back();
+        epsilon.emplace_back();
+        accepting.push_back(accept);
+        return stateCount() - 1;
+    }
+
+    void addTransition(int from, char symbol, int to)
+    {
+        edges[from].push_back({symbol, to});
+    }
+
+    void addEpsilonTransition(int from, int to)
+    {
+        epsilon[from].push_back(to);
+    }
+
+    // Renumbers the states of a map-based NFA densely.
+    static IndexedNFA fromNFA(const NFA &nfa, const std::set<int> &states)
+    {
+        IndexedNFA result;
+        std::map<int, int> id;
+        auto intern = [&](int state)
+        {
+            if (!id.count(state))
+                id[state] = result.addState(nfa.acceptStates.count(state));
+            return id[state];
+        };
+        for (int state : states)
+            intern(state);
+        result.startState = intern(nfa.startState);
+        for (const auto &row : nfa.transition)
+            for (const auto &edge : row.second)
+                for (int to : edge.second)
+                    result.addTransition(intern(row.first), edge.first, intern(to));
+        return result;
+    }
+};
+
+// Epsilon-closure of every NFA state, each computed once on first use.
+class EpsilonClosure
+{
+    const IndexedNFA &nfa;
+    std::vector<StateSet> cache;
+    std::vector<bool> done;
+
+public:
+    explicit EpsilonClosure(const IndexedNFA &nfa)
+        : nfa(nfa), cache(nfa.stateCount()), done(nfa.stateCount(), false) {}
+
+    const StateSet &of(int state)
+    {
+        if (done[state])
+            return cache[state];
+
+        StateSet closure(nfa.stateCount());
+        std::vector<int> stack = {state};
+        closure.insert(state);
+        while (!stack.empty())
+        {
+            int s = stack.back();
+            stack.pop_back();
+            if (s != state && done[s])
+            {
+                closure.unite(cache[s]); // Already closed, no need to expand
+                continue;
+            }
+            for (int to : nfa.epsilon[s])
+            {
+                if (!closure.contains(to))
+                {
+                    closure.insert(to);
+                    stack.push_back(to);
+                }
+            }
+        }
+        cache[state] = std::move(closure);
+        done[state] = true;
+        return cache[state];
+    }
+};
+
+// DFA with dense state ids and a row-major state x symbol transition table.
+class IndexedDFA
+{
+public:
+    static constexpr int DEAD = -1;
+
+    std::vector<char> alphabet;
+    std::array<int, 256> symbolIndex; // byte -> column, -1 if not in the alphabet
+    std::vector<int> transition;      // stateCount() x alphabet.size()
+    std::vector<bool> accepting;
+    int startState = 0;
+
+    IndexedDFA() { symbolIndex.fill(-1); }
+
+    int stateCount() const { return accepting.size(); }
+
+    int next(int state, char symbol) const
+    {
+        int column = symbolIndex[(unsigned char)symbol];
+        return column < 0 ? DEAD : transition[state * alphabet.size() + column];
+    }
+
+    bool isAccepted(std::string_view input) const
+    {
+        int currentState = startState;
+        CDLAB_COUNT(Metric::DFA_MATCHES, 1);
+        for (size_t i = 0; i < input.size(); i++)
+        {
+            currentState = next(currentState, input[i]);
+            if (currentState == DEAD)
+            {
+                CDLAB_COUNT(Metric::DFA_BYTES, i + 1);
+                CDLAB_COUNT(Metric::DFA_DEAD_EXITS, 1);
+                return false;
+            }
+        }
+        CDLAB_COUNT(Metric::DFA_BYTES, input.size());
+        return accepting[currentState];
+    }
+
+    // Dense byte-class form, as DFA::compile builds it: state s becomes s + 1,
+    // and bytes outside the alphabet share the all-dead column.
+    CompiledDFA compile() const
+    {
+        CompiledDFA compiled;
+        int n = stateCount(), k = alphabet.size();
+        compiled.stateCount = n + 1;
+        compiled.startState = n > 0 ? startState + 1 : CompiledDFA::DEAD;
+
+        std::map<std::vector<int>, int> classOf = {{std::vector<int>(n + 1, CompiledDFA::DEAD), 0}};
+        std::vector<int> representative = {-1}; // symbol index per class; -1 is the dead column
+        std::vector<int> column(n + 1);
+        compiled.byteClass.fill(0);
+        for (int c = 0; c < k; c++)
+        {
+            column[0] = CompiledDFA::DEAD;
+            for (int s = 0; s < n; s++)
+                column[s + 1] = transition[s * k + c] + 1; // DEAD (-1) becomes 0
+            auto it = classOf.insert({column, (int)representative.size()}).first;
+            if (it->second == (int)representative.size())
+                representative.push_back(c);
+            compiled.byteClass[(unsigned char)alphabet[c]] = it->second;
+        }
+
+        compiled.classCount = representative.size();
+        compiled.table.assign(compiled.stateCount * compiled.classCount, CompiledDFA::DEAD);
+        for (int s = 0; s < n; s++)
+            for (int c = 1; c < compiled.classCount; c++)
+                compiled.table[(s + 1) * compiled.classCount + c] = transition[s * k + representative[c]] + 1;
+        compiled.acceptBits.assign((compiled.stateCount + 63) / 64, 0);
+        for (int s = 0; s < n; s++)
+            if (accepting[s])
+                compiled.acceptBits[(s + 1) >> 6] |= uint64_t(1) << ((s + 1) & 63);
+        return compiled;
+    }
+};
+
+// Subset construction over bitset subsets; each distinct subset is interned
+// once and given the next dense DFA state id in BFS order.
+inline IndexedDFA convertNFAtoDFA(const IndexedNFA &nfa)
+{
+    CDLAB_TIME_SCOPE(Metric::SUBSET_SECONDS);
+    IndexedDFA dfa;
+    int n = nfa.stateCount();
+
+    for (const auto &out : nfa.edges)
+        for (const auto &edge : out)
+            dfa.alphabet.push_back(edge.first);
+    std::sort(dfa.alphabet.begin(), dfa.alphabet.end());
+    dfa.alphabet.erase(std::unique(dfa.alphabet.begin(), dfa.alphabet.end()), dfa.alphabet.end());
+    for (size_t i = 0; i < dfa.alphabet.size(); i++)
+        dfa.symbolIndex[(unsigned char)dfa.alphabet[i]] = i;
+    int k = dfa.alphabet.size();
+
+    StateSet acceptMask(n);
+    for (int s = 0; s < n; s++)
+        if (nfa.accepting[s])
+            acceptMask.insert(s);
+
+    EpsilonClosure closure(nfa);
+    std::unordered_map<StateSet, int, StateSetHash> ids;
+    std::vector<const StateSet *> subsets; // DFA state id -> interned subset
+
+    auto intern = [&](const StateSet &subset)
+    {
+        auto it = ids.find(subset);
+        if (it != ids.end())
+            return it->second;
+        int id = subsets.size();
+        it = ids.emplace(subset, id).first;
+        subsets.push_back(&it->first);
+        dfa.accepting.push_back(it->first.intersects(acceptMask));
+        dfa.transition.resize(dfa.transition.size() + k, IndexedDFA::DEAD);
+        CDLAB_COUNT(Metric::SUBSET_STATES, 1);
+        CDLAB_RECORD_MAX(Metric::SUBSET_PEAK_SIZE, subset.count());
+        return id;
+    };
+
+    dfa.startState = intern(closure.of(nfa.startState));
+
+    std::vector<StateSet> successors(k, StateSet(n));
+    for (size_t current = 0; current < subsets.size(); current++)
+    {
+        for (StateSet &s : successors)
+            s.clear();
+        subsets[current]->forEach([&](int state)
+        {
+            for (const auto &edge : nfa.edges[state])
+                successors[dfa.symbolIndex[(unsigned char)edge.first]].unite(closure.of(edge.second));
+        });
+
+        for (int c = 0; c < k; c++)
+        {
+            if (!successors[c].empty())
+            {
+                dfa.transition[current * k + c] = intern(successors[c]);
+                CDLAB_COUNT(Metric::SUBSET_TRANSITIONS, 1);
+            }
+        }
+    }
+
+    return dfa;
+}
+
+// Subset -> DFA state id table shared by the parallel construction. Keys are
+// spread over independently locked shards; ids come from one atomic counter.
+class ConcurrentSubsetTable
+{
+    struct Shard
+    {
+        std::mutex lock;
+        std::unordered_map<StateSet, int, StateSetHash> ids;
+    };
+    std::vector<Shard> shards;
+    std::atomic<int> nextId{0};
+
+public:
+    explicit ConcurrentSubsetTable(int shardCount) : shards(shardCount) {}
+
+    int size() const { return nextId.load(); }
+
+    // Returns the id of `subset` and the interned copy; `created` tells the
+    // caller whether it is responsible for expanding the new state.
+    std::pair<int, const StateSet *> intern(const StateSet &subset, bool &created)
+    {
+        Shard &shard = shards[StateSetHash()(subset) % shards.size()];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto it = shard.ids.find(subset);
+        created = it == shard.ids.end();
+        if (created)
+            it = shard.ids.emplace(subset, nextId++).first;
+        return {it->second, &it->first};
+    }
+};
+
+// Per-worker deque: the owner pushes and pops at the back, thieves take
+// from the front.
+template <typename T>
+class WorkStealingQueue
+{
+    std::mutex lock;
+    std::deque<T> items;
+
+public:
+    void push(const T &item)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        items.push_back(item);
+    }
+
+    bool pop(T &item)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (items.empty())
+            return false;
+        item = items.back();
+        items.pop_back();
+        return true;
+    }
+
+    bool steal(T &item)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (items.empty())
+            return false;
+        item = items.front();
+        items.pop_front();
+        return true;
+    }
+};
+
+// Renumbers reachable states in BFS order from the start state, visiting
+// symbols in alphabet order. This is the numbering the serial construction
+// produces, so both paths give identical tables.
+inline IndexedDFA renumberBFS(const IndexedDFA &dfa)
+{
+    int k = dfa.alphabet.size();
+    std::vector<int> newId(dfa.stateCount(), IndexedDFA::DEAD);
+    std::vector<int> order = {dfa.startState};
+    newId[dfa.startState] = 0;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        for (int c = 0; c < k; c++)
+        {
+            int t = dfa.transition[order[i] * k + c];
+            if (t != IndexedDFA::DEAD && newId[t] == IndexedDFA::DEAD)
+            {
+                newId[t] = order.size();
+                order.push_back(t);
+            }
+        }
+    }
+
+    IndexedDFA result;
+    result.alphabet = dfa.alphabet;
+    result.symbolIndex = dfa.symbolIndex;
+    result.startState = 0;
+    result.accepting.resize(order.size());
+    result.transition.assign(order.size() * k, IndexedDFA::DEAD);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        result.accepting[i] = dfa.accepting[order[i]];
+        for (int c = 0; c < k; c++)
+        {
+            int t = dfa.transition[order[i] * k + c];
+            result.transition[i * k + c] = t == IndexedDFA::DEAD ? IndexedDFA::DEAD : newId[t];
+        }
+    }
+    return result;
+}
+
+// Parallel subset construction. Workers expand frontier subsets for every
+// symbol, deduplicate successors through a sharded table and balance the
+// frontier by stealing from each other's queues. Rows are collected per
+// worker and assembled afterwards, then renumbered to match the serial
+// construction exactly.
+inline IndexedDFA convertNFAtoDFAParallel(const IndexedNFA &nfa, int threadCount = 0)
+{
+    if (threadCount <= 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    CDLAB_TIME_SCOPE(Metric::SUBSET_SECONDS);
+    IndexedDFA dfa;
+    int n = nfa.stateCount();
+    for (const auto &out : nfa.edges)
+        for (const auto &edge : out)
+            dfa.alphabet.push_back(edge.first);
+    std::sort(dfa.alphabet.begin(), dfa.alphabet.end());
+    dfa.alphabet.erase(std::unique(dfa.alphabet.begin(), dfa.alphabet.end()), dfa.alphabet.end());
+    for (size_t i = 0; i < dfa.alphabet.size(); i++)
+        dfa.symbolIndex[(unsigned char)dfa.alphabet[i]] = i;
+    int k = dfa.alphabet.size();
+
+    StateSet acceptMask(n);
+    for (int s = 0; s < n; s++)
+        if (nfa.accepting[s])
+            acceptMask.insert(s);
+
+    // Fill the closure cache up front so workers only ever read it.
+    EpsilonClosure closure(nfa);
+    for (int s = 0; s < n; s++)
+        closure.of(s);
+
+    struct Task
+    {
+        int id;
+        const StateSet *subset;
+    };
+    struct Row
+    {
+        int id;
+        bool accepting;
+        std::vector<int> targets;
+    };
+
+    ConcurrentSubsetTable table(threadCount * 16);
+    std::vector<WorkStealingQueue<Task>> queues(threadCount);
+    std::vector<std::vector<Row>> rows(threadCount);
+    std::atomic<long long> pending{1};
+
+    bool created;
+    auto start = table.intern(closure.of(nfa.startState), created);
+    queues[0].push({start.first, start.second});
+    CDLAB_COUNT(Metric::SUBSET_STATES, 1);
+    CDLAB_RECORD_MAX(Metric::SUBSET_PEAK_SIZE, start.second->count());
+
+    auto worker = [&](int self)
+    {
+        std::vector<StateSet> successors(k, StateSet(n));
+        Task task;
+        while (true)
+        {
+            bool found = queues[self].pop(task);
+            for (int i = 1; !found && i < threadCount; i++)
+                found = queues[(self + i) % threadCount].steal(task);
+            if (!found)
+            {
+                if (pending.load() == 0)
+                    return;
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (StateSet &s : successors)
+                s.clear();
+            task.subset->forEach([&](int state)
+            {
+                for (const auto &edge : nfa.edges[state])
+                    successors[dfa.symbolIndex[(unsigned char)edge.first]].unite(closure.of(edge.second));
+            });
+
+            Row row{task.id, task.subset->intersects(acceptMask), std::vector<int>(k, IndexedDFA::DEAD)};
+            for (int c = 0; c < k; c++)
+            {
+                if (successors[c].empty())
+                    continue;
+                bool isNew;
+                auto target = table.intern(successors[c], isNew);
+                row.targets[c] = target.first;
+                CDLAB_COUNT(Metric::SUBSET_TRANSITIONS, 1);
+                if (isNew)
+                {
+                    CDLAB_COUNT(Metric::SUBSET_STATES, 1);
+                    CDLAB_RECORD_MAX(Metric::SUBSET_PEAK_SIZE, successors[c].count());
+                    pending++;
+                    queues[self].push({target.first, target.second});
+                }
+            }
+            rows[self].push_back(std::move(row));
+            pending--;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; t++)
+        threads.emplace_back(worker, t);
+    worker(0);
+    for (std::thread &t : threads)
+        t.join();
+
+    dfa.startState = start.first;
+    dfa.accepting.assign(table.size(), false);
+    dfa.transition.assign(table.size() * k, IndexedDFA::DEAD);
+    for (const auto &local : rows)
+    {
+        for (const Row &row : local)
+        {
+            dfa.accepting[row.id] = row.accepting;
+            std::copy(row.targets.begin(), row.targets.end(), dfa.transition.begin() + row.id * k);
+        }
+    }
+    return renumberBFS(dfa);
+}
+
+struct MinimizationReport
+{
+    int statesBefore = 0;
+    int statesAfter = 0;
+};
+
+// Hopcroft partition refinement. Missing transitions go to an implicit sink
+// state; whatever ends up equivalent to the sink becomes DEAD. The result is
+// renumbered in BFS order from the start state so states that are visited
+// together sit next to each other in the transition table.
+inline IndexedDFA minimizeDFA(const IndexedDFA &dfa, MinimizationReport *report = nullptr)
+{
+    int n = dfa.stateCount() + 1; // last state is the sink
+    int sink = n - 1;
+    int k = dfa.alphabet.size();
+    auto target = [&](int s, int c)
+    {
+        if (s == sink)
+            return sink;
+        int t = dfa.transition[s * k + c];
+        return t == IndexedDFA::DEAD ? sink : t;
+    };
+
+    // Inverse transitions per symbol, in CSR form.
+    std::vector<std::vector<int>> inverseStart(k, std::vector<int>(n + 1, 0));
+    std::vector<std::vector<int>> inverse(k, std::vector<int>(n));
+    for (int c = 0; c < k; c++)
+    {
+        for (int s = 0; s < n; s++)
+            inverseStart[c][target(s, c) + 1]++;
+        for (int t = 0; t < n; t++)
+            inverseStart[c][t + 1] += inverseStart[c][t];
+        std::vector<int> fill = inverseStart[c];
+        for (int s = 0; s < n; s++)
+            inverse[c][fill[target(s, c)]++] = s;
+    }
+
+    // Refinable partition: each block is a contiguous range of `elements`,
+    // with its marked states moved to the front of the range.
+    std::vector<int> elements(n), location(n), blockOf(n);
+    std::vector<int> blockStart, blockEnd, markedEnd;
+    auto addBlock = [&](int start, int end)
+    {
+        blockStart.push_back(start);
+        blockEnd.push_back(end);
+        markedEnd.push_back(start);
+        for (int i = start; i < end; i++)
+            blockOf[elements[i]] = blockStart.size() - 1;
+        return (int)blockStart.size() - 1;
+    };
+
+    int split = 0;
+    for (int s = 0; s < n; s++)
+        if (s != sink && dfa.accepting[s])
+            elements[split++] = s;
+    int rest = split;
+    for (int s = 0; s < n; s++)
+        if (s == sink || !dfa.accepting[s])
+            elements[rest++] = s;
+    for (int i = 0; i < n; i++)
+        location[elements[i]] = i;
+
+    std::vector<std::pair<int, int>> worklist; // (block, symbol)
+    std::vector<bool> pending;
+    auto push = [&](int block, int c)
+    {
+        if (pending.size() < blockStart.size() * k)
+            pending.resize(blockStart.size() * k, false);
+        if (!pending[block * k + c])
+        {
+            pending[block * k + c] = true;
+            worklist.push_back({block, c});
+        }
+    };
+
+    if (split == 0 || split == n)
+    {
+        addBlock(0, n);
+    }
+    else
+    {
+        int accepting = addBlock(0, split);
+        int other = addBlock(split, n);
+        int smaller = split <= n - split ? accepting : other;
+        for (int c = 0; c < k; c++)
+            push(smaller, c);
+    }
+
+    std::vector<int> splitter, touched;
+    while (!worklist.empty())
+    {
+        auto [block, c] = worklist.back();
+        worklist.pop_back();
+        pending[block * k + c] = false;
+
+        splitter.assign(elements.begin() + blockStart[block], elements.begin() + blockEnd[block]);
+        for (int t : splitter)
+        {
+            for (int i = inverseStart[c][t]; i < inverseStart[c][t + 1]; i++)
+            {
+                int s = inverse[c][i];
+                int b = blockOf[s];
+                int pos = location[s];
+                if (pos < markedEnd[b])
+                    continue; // already marked
+                if (markedEnd[b] == blockStart[b])
+                    touched.push_back(b);
+                int swapWith = elements[markedEnd[b]];
+                std::swap(elements[pos], elements[markedEnd[b]]);
+                location[swapWith] = pos;
+                location[s] = markedEnd[b]++;
+            }
+        }
+
+        for (int b : touched)
+        {
+            if (markedEnd[b] == blockEnd[b])
+            {
+                markedEnd[b] = blockStart[b];
+                continue;
+            }
+            // Marked part becomes a new block; the old block keeps the rest.
+            int start = blockStart[b], mid = markedEnd[b];
+            blockStart[b] = mid;
+            markedEnd[b] = mid;
+            int created = addBlock(start, mid);
+            for (int a = 0; a < k; a++)
+            {
+                if (pending.size() > (size_t)(b * k + a) && pending[b * k + a])
+                    push(created, a);
+                else if (mid - start <= blockEnd[b] - blockStart[b])
+                    push(created, a);
+                else
+                    push(b, a);
+            }
+        }
+        touched.clear();
+    }
+
+    // Renumber live blocks in BFS order from the start block.
+    int blockCount = blockStart.size();
+    int sinkBlock = blockOf[sink];
+    std::vector<int> newId(blockCount, IndexedDFA::DEAD);
+    int startBlock = blockOf[dfa.startState];
+    newId[startBlock] = 0; // kept even if it is equivalent to the sink, whose edges stay DEAD
+    std::vector<int> order = {startBlock};
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        int representative = elements[blockStart[order[i]]];
+        for (int c = 0; c < k; c++)
+        {
+            int b = blockOf[target(representative, c)];
+            if (b != sinkBlock && newId[b] == IndexedDFA::DEAD)
+            {
+                newId[b] = order.size();
+                order.push_back(b);
+            }
+        }
+    }
+
+    IndexedDFA result;
+    result.alphabet = dfa.alphabet;
+    result.symbolIndex = dfa.symbolIndex;
+    result.startState = 0;
+    result.accepting.resize(order.size());
+    result.transition.assign(order.size() * k, IndexedDFA::DEAD);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        int representative = elements[blockStart[order[i]]];
+        result.accepting[i] = representative != sink && dfa.accepting[representative];
+        for (int c = 0; c < k; c++)
+        {
+            int b = blockOf[target(representative, c)];
+            result.transition[i * k + c] = b == sinkBlock ? IndexedDFA::DEAD : newId[b];
+        }
+    }
+
+    if (report)
+    {
+        report->statesBefore = dfa.stateCount();
+        report->statesAfter = result.stateCount();
+    }
+    return result;
+}
+
+// Matches directly against an IndexedNFA, determinizing subsets only as the
+// input reaches them. Cached states are charged against a memory budget;
+// when it runs out the whole cache is flushed and rebuilt from the current
+// subset. If flushes keep coming before the cache has paid for itself, the
+// rest of the input is matched by plain NFA simulation instead. The flush
+// history is kept across calls, so many short inputs that each overflow the
+// cache once are caught as well.
+class LazyDFA
+{
+public:
+    static constexpr int DEAD = -1;
+    static constexpr int UNKNOWN = -2;
+
+    struct Stats
+    {
+        long long statesBuilt = 0;
+        long long flushes = 0;
+        long long fallbacks = 0;
+    };
+
+    explicit LazyDFA(const IndexedNFA &nfa, size_t memoryBudget = 1 << 20)
+        : nfa(nfa), closure(nfa), acceptMask(nfa.stateCount()), memoryBudget(memoryBudget)
+    {
+        symbolIndex.fill(-1);
+        for (const auto &out : nfa.edges)
+            for (const auto &edge : out)
+                if (symbolIndex[(unsigned char)edge.first] < 0)
+                    symbolIndex[(unsigned char)edge.first] = symbolCount++;
+        for (int s = 0; s < nfa.stateCount(); s++)
+            if (nfa.accepting[s])
+                acceptMask.insert(s);
+    }
+
+    const Stats &stats() const { return counters; }
+    int cachedStates() const { return subsets.size(); }
+    size_t memoryUsed() const { return used; }
+
+    bool isAccepted(std::string_view input)
+    {
+        if (startId == DEAD)
+            startId = intern(closure.of(nfa.startState));
+        int current = startId;
+
+        for (size_t i = 0; i < input.size(); i++)
+        {
+            int c = symbolIndex[(unsigned char)input[i]];
+            if (c < 0)
+                return false;
+
+            int next = transitions[current * symbolCount + c];
+            if (next == UNKNOWN)
+            {
+                StateSet target = step(*subsets[current], c);
+                if (target.empty())
+                {
+                    next = DEAD;
+                }
+                else if (used + stateCost() > memoryBudget && !ids.count(target))
+                {
+                    if (sinceFlush >= 10 * subsets.size())
+                        thrash = 0; // the cache paid for itself since the last flush
+                    else if (thrash < maxThrash)
+                        thrash++;
+                    if (thrash == maxThrash)
+                    {
+                        counters.fallbacks++;
+                        return simulate(std::move(target), input.substr(i + 1));
+                    }
+                    flush();
+                    current = DEAD;
+                    next = intern(target);
+                }
+                else
+                {
+                    next = intern(target);
+                }
+                if (current != DEAD)
+                    transitions[current * symbolCount + c] = next;
+            }
+            if (next == DEAD)
+                return false;
+            current = next;
+            sinceFlush++;
+        }
+        return accepting[current];
+    }
+
+private:
+    static constexpr int maxThrash = 3;
+
+    const IndexedNFA &nfa;
+    EpsilonClosure closure;
+    std::array<int, 256> symbolIndex;
+    int symbolCount = 0;
+    StateSet acceptMask;
+    size_t memoryBudget;
+    size_t used = 0;
+    Stats counters;
+
+    std::unordered_map<StateSet, int, StateSetHash> ids;
+    std::vector<const StateSet *> subsets;
+    std::vector<bool> accepting;
+    std::vector<int> transitions; // cachedStates() x symbolCount, UNKNOWN until computed
+    int startId = DEAD;
+    size_t sinceFlush = 0; // cached steps taken since the last flush
+    int thrash = 0;        // flushes in a row that came before the cache paid off
+
+    size_t stateCost() const
+    {
+        return acceptMask.words.size() * sizeof(uint64_t) + symbolCount * sizeof(int) + 64;
+    }
+
+    StateSet step(const StateSet &from, int c)
+    {
+        StateSet target(nfa.stateCount());
+        from.forEach([&](int state)
+        {
+            for (const auto &edge : nfa.edges[state])
+                if (symbolIndex[(unsigned char)edge.first] == c)
+                    target.unite(closure.of(edge.second));
+        });
+        return target;
+    }
+
+    int intern(const StateSet &subset)
+    {
+        auto it = ids.find(subset);
+        if (it != ids.end())
+            return it->second;
+        int id = subsets.size();
+        it = ids.emplace(subset, id).first;
+        subsets.push_back(&it->first);
+        accepting.push_back(subset.intersects(acceptMask));
+        transitions.resize(transitions.size() + symbolCount, UNKNOWN);
+        used += stateCost();
+        counters.statesBuilt++;
+        return id;
+    }
+
+    void flush()
+    {
+        ids.clear();
+        subsets.clear();
+        accepting.clear();
+        transitions.clear();
+        used = 0;
+        startId = DEAD;
+        sinceFlush = 0;
+        counters.flushes++;
+    }
+
+    bool simulate(StateSet current, std::string_view rest)
+    {
+        for (char symbol : rest)
+        {
+            int c = symbolIndex[(unsigned char)symbol];
+            if (c < 0)
+                return false;
+            current = step(current, c);
+            if (current.empty())
+                return false;
+        }
+        return current.intersects(acceptMask);
+    }
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+constexpr size_t perfectHashTableSize(size_t wordCount)
+{
+    size_t size = 1;
+    while (size < 2 * wordCount)
+        size *= 2;
+    return size;
+}
+
+// Fixed word set hashed without collisions at compile time: a lookup is one
+// hash, one slot load and one comparison, with no allocation or probing.
+// Build one with makePerfectHashSet from a constexpr array of distinct words.
+template <size_t N>
+class PerfectHashSet
+{
+public:
+    static constexpr size_t tableSize() { return perfectHashTableSize(N); }
+
+    std::array<std::string_view, perfectHashTableSize(N)> slots{};
+    std::array<int, perfectHashTableSize(N)> ids{};
+    uint32_t seed = 0;
+
+    static constexpr uint32_t hash(std::string_view word, uint32_t seed)
+    {
+        uint32_t h = seed ^ uint32_t(word.size());
+        for (char c : word)
+            h = (h ^ (unsigned char)c) * 16777619u;
+        return h ^ (h >> 15);
+    }
+
+    // Index of `word` in the list the set was built from, or -1.
+    constexpr int find(std::string_view word) const
+    {
+        size_t slot = hash(word, seed) & (tableSize() - 1);
+        return ids[slot] >= 0 && slots[slot] == word ? ids[slot] : -1;
+    }
+
+    constexpr bool contains(std::string_view word) const { return find(word) >= 0; }
+    static constexpr size_t size() { return N; }
+};
+
+template <size_t N>
+constexpr PerfectHashSet<N> makePerfectHashSet(const std::string_view (&words)[N])
+{
+    PerfectHashSet<N> set;
+    constexpr size_t mask = PerfectHashSet<N>::tableSize() - 1;
+    for (uint32_t seed = 1;; seed++)
+    {
+        for (size_t i = 0; i <= mask; i++)
+            set.ids[i] = -1;
+
+        bool collision = false;
+        for (size_t w = 0; w < N && !collision; w++)
+        {
+            size_t slot = PerfectHashSet<N>::hash(words[w], seed) & mask;
+            collision = set.ids[slot] >= 0;
+            set.slots[slot] = words[w];
+            set.ids[slot] = w;
+        }
+        if (!collision)
+        {
+            set.seed = seed;
+            return set;
+        }
+    }
+}
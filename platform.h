@@ -0,0 +1,11 @@
+#pragma once
+
+// Target detection shared by the SIMD kernels and the benchmark clock.
+// CDLAB_X86 is defined on x86 and x86-64, where the intrinsics headers are
+// available; AVX2 code is compiled per function with target("avx2") and
+// only called after a run-time CPU check.
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#include <x86intrin.h>
+#define CDLAB_X86 1
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <iostream>
+#include <cctype>
+#include <string_view>
+class RecursiveDescentParser
+{
+public:
+    // Each parenthesis costs three stack frames, so deeper nesting is rejected
+    // rather than overflowing a small (e.g. worker thread) stack.
+    static constexpr size_t maxNesting = 1000;
+
+private:
+    std::string_view input;
+    size_t pos;
+    size_t depth;
+
+    char peek() { return pos < input.length() ? input[pos] : '\0'; }
+    void advance() { pos++; }
+
+    bool match(char expected)
+    {
+        if (peek() == expected)
+        {
+            advance();
+            return true;
+        }
+        return false;
+    }
+
+    // Grammar Parsing Functions
+    bool E() { return T() && EPrime(); }                          // E → T E'
+    bool EPrime() { return match('+') ? T() && EPrime() : true; } // E' → + T E' | ε
+    bool T() { return F() && TPrime(); }                          // T → F T'
+    bool TPrime() { return match('*') ? F() && TPrime() : true; } // T' → * F T' | ε
+    bool F()
+    { // F → (E) | id (number)
+        if (isdigit(peek()))
+        {
+            advance();
+            return true;
+        }
+        if (depth < maxNesting && match('('))
+        {
+            depth++;
+            if (E() && match(')'))
+            {
+                depth--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    bool parse(std::string_view expr)
+    {
+        input = expr;
+        pos = 0;
+        depth = 0;
+        return E() && pos == input.length(); // Ensure complete parsing
+    }
+
+    // Where parsing stopped after parse() returned false.
+    size_t errorOffset() const { return pos; }
+};
@@ -0,0 +1,804 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <unistd.h>
+#include "corpus.h"
+#include "nfa.h"
+#include "dfa.h"
+#include "dfa_image.h"
+#include "bit_parallel_nfa.h"
+#include "lexical_analyzer.h"
+#include "incremental_lexer.h"
+#include "aho_corasick.h"
+#include "recursive_descent_parser.h"
+#include "expression_parser.h"
+#include "batch_validator.h"
+#include "left_factoring.h"
+#include "left_recursion.h"
+#include "ll1_parser.h"
+#include "lalr_parser.h"
+#include "dfa16_switch.h"
+#include "dfa16_table.h"
+#include "dfa1024_switch.h"
+#include "dfa1024_table.h"
+
+using namespace std;
+
+// Differential checks: every fast path against the implementation it
+// replaces, on the seeded inputs the benchmarks use.
+// Usage: differential <group>, one of the groups listed in main()
+
+int failures = 0;
+
+uint64_t seedFor(int n) { return 42 + n; }
+
+void check(bool ok, const string &what)
+{
+    if (!ok && failures++ < 20)
+        cerr << "FAILED: " << what << "\n";
+}
+
+// Automata covering every BitParallelNFA kernel (up to 64, 128 and 256
+// positions and beyond), with and without epsilon edges, and the
+// exponential suffix family.
+vector<pair<string, IndexedNFA>> sampleNFAs()
+{
+    vector<pair<string, IndexedNFA>> nfas;
+    for (int patterns : {1, 4, 12, 24, 40, 60, 200})
+        for (bool useEpsilon : {true, false})
+            nfas.push_back({"patterns:" + to_string(patterns) + (useEpsilon ? "/epsilon" : ""),
+                            generatePatternUnionNFA(patterns, 8, seedFor(patterns), useEpsilon)});
+    for (int k : {1, 3, 6, 9})
+        nfas.push_back({"suffix:" + to_string(k), generateSuffixNFA(k)});
+    return nfas;
+}
+
+// Random walks through the DFA that often stop in an accepting state, so
+// both outcomes are well represented, with some bytes replaced by arbitrary
+// letters or bytes outside the alphabet.
+vector<string> sampleInputs(const IndexedDFA &dfa, int count, uint64_t seed)
+{
+    CorpusRng rng(seed);
+    vector<string> inputs = {""};
+    int k = dfa.alphabet.size();
+    for (int i = 0; i < count; i++)
+    {
+        string input;
+        int state = dfa.startState;
+        while (input.size() < 32 && k > 0 && state != IndexedDFA::DEAD && !rng.chance(3))
+        {
+            if (dfa.accepting[state] && rng.chance(50))
+                break;
+            char c = dfa.alphabet[rng.below(k)];
+            if (rng.chance(5))
+                c = rng.chance(50) ? char('a' + rng.below(26)) : char(rng.below(256));
+            input += c;
+            state = dfa.next(state, c);
+        }
+        inputs.push_back(input);
+    }
+    return inputs;
+}
+
+void testSubsetConstruction()
+{
+    for (const auto &[name, nfa] : sampleNFAs())
+    {
+        IndexedDFA serial = convertNFAtoDFA(nfa);
+        for (int threads : {1, 2, 3, 8})
+        {
+            IndexedDFA parallel = convertNFAtoDFAParallel(nfa, threads);
+            string what = name + " threads:" + to_string(threads);
+            check(parallel.alphabet == serial.alphabet, what + " alphabet");
+            check(parallel.startState == serial.startState, what + " start state");
+            check(parallel.transition == serial.transition, what + " transitions");
+            check(parallel.accepting == serial.accepting, what + " accepting states");
+        }
+    }
+}
+
+void testMatchers()
+{
+    for (const auto &[name, nfa] : sampleNFAs())
+    {
+        IndexedDFA reference = convertNFAtoDFA(nfa);
+        IndexedDFA minimized = minimizeDFA(reference);
+        CompiledDFA compiled = minimized.compile();
+        LazyDFA lazy(nfa);
+        LazyDFA thrashing(nfa, 1024); // flushes and falls back to simulation
+        BitParallelNFA bitParallel(nfa);
+
+        check(minimizeDFA(minimized).stateCount() == minimized.stateCount(), name + " minimization is idempotent");
+        check(minimized.stateCount() <= reference.stateCount(), name + " minimization grows the DFA");
+        for (const string &input : sampleInputs(reference, 2000, seedFor(reference.stateCount())))
+        {
+            bool expected = reference.isAccepted(input);
+            string what = name + " input \"" + input + "\"";
+            check(minimized.isAccepted(input) == expected, what + " minimized");
+            check(compiled.matches(input) == expected, what + " compiled");
+            check(lazy.isAccepted(input) == expected, what + " lazy");
+            check(thrashing.isAccepted(input) == expected, what + " lazy with a small budget");
+            check(bitParallel.isAccepted(input) == expected, what + " bit-parallel " + bitParallel.kernelName());
+        }
+    }
+
+    // No accepting state: the start block is the sink block, and its edges
+    // must stay DEAD rather than loop back to the start.
+    IndexedNFA empty;
+    empty.startState = empty.addState();
+    empty.addTransition(empty.startState, 'x', empty.addState());
+    IndexedDFA minimized = minimizeDFA(convertNFAtoDFA(empty));
+    check(minimized.stateCount() == 1 && minimized.transition == vector<int>{IndexedDFA::DEAD},
+          "empty language minimizes to a start state with DEAD edges");
+}
+
+void testParallelLexer()
+{
+    vector<string> sources = {"", "int", "\n\n", "x = 1;\ny = \"a b\"; // c\n\nwhile (x)", generateSource(1 << 18, 42)};
+    for (const string &code : sources)
+    {
+        LexicalAnalyzer serial;
+        serial.analyze(code);
+        const TokenBuffer &expected = serial.tokenBuffer();
+        for (int threads : {1, 2, 3, 8})
+        {
+            LexicalAnalyzer parallel;
+            parallel.analyzeParallel(code, threads);
+            const TokenBuffer &tokens = parallel.tokenBuffer();
+            string what = to_string(code.size()) + " bytes, threads:" + to_string(threads);
+            check(tokens.kinds == expected.kinds, what + " kinds");
+            check(tokens.symbols == expected.symbols, what + " symbols");
+            check(tokens.offsets == expected.offsets, what + " offsets");
+            check(tokens.lengths == expected.lengths, what + " lengths");
+            check(tokens.lines == expected.lines, what + " lines");
+
+            const SymbolTable &names = parallel.symbolTable();
+            bool sameNames = names.size() == serial.symbolTable().size();
+            for (uint32_t id = 0; sameNames && id < names.size(); id++)
+                sameNames = names.name(id) == serial.symbolTable().name(id);
+            check(sameNames, what + " symbol table");
+        }
+    }
+}
+
+bool writeFile(const string &path, const string &bytes)
+{
+    ofstream out(path, ios::binary | ios::trunc);
+    out.write(bytes.data(), bytes.size());
+    return bool(out);
+}
+
+void testDFAImage()
+{
+    string path = "/tmp/cdlab_test_" + to_string(getpid()) + ".dfa";
+    vector<pair<string, CompiledDFA>> images;
+    for (int patterns : {1, 60})
+        images.push_back({"patterns:" + to_string(patterns), minimizeDFA(convertNFAtoDFA(generatePatternUnionNFA(patterns, 8, seedFor(patterns)))).compile()});
+    DFA random = generateDFA(64, 4, 42);
+    random.compile();
+    images.push_back({"random DFA", random.compiledForm()});
+
+    for (const auto &[name, compiled] : images)
+    {
+        check(saveDFAImage(compiled, path), name + " save");
+        MappedDFA mapped;
+        bool opened = mapped.open(path);
+        check(opened, name + " open: " + mapped.error());
+        if (!mapped.isOpen())
+            continue;
+        const DFAView &view = mapped.view();
+        check(view.classCount == compiled.classCount && view.stateCount == compiled.stateCount &&
+                  view.startState == compiled.startState,
+              name + " header");
+        check(memcmp(view.byteClass, compiled.byteClass.data(), 256) == 0, name + " byte classes");
+        check(memcmp(view.table, compiled.table.data(), compiled.table.size() * sizeof(int32_t)) == 0, name + " table");
+        CorpusRng rng(seedFor(compiled.stateCount));
+        for (int i = 0; i < 2000; i++)
+        {
+            string input = generateDFAInput(rng.below(32), 26, rng.next());
+            check(mapped.matches(input) == compiled.matches(input), name + " input \"" + input + "\"");
+        }
+        mapped.close();
+
+        // Every single-bit corruption, header included, must be rejected.
+        ifstream in(path, ios::binary);
+        string image((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        size_t limit = min(image.size(), size_t(4096));
+        for (size_t bit = 0; bit < limit * 8; bit++)
+        {
+            string corrupted = image;
+            corrupted[bit / 8] ^= char(1 << (bit % 8));
+            if (!writeFile(path, corrupted))
+                continue;
+            check(!mapped.open(path), name + " accepted a flip of bit " + to_string(bit));
+        }
+    }
+    remove(path.c_str());
+}
+
+// Random strings over the DFA's symbols, mostly walks along its edges so
+// that both outcomes show up, with some arbitrary bytes mixed in.
+vector<string> sampleWalks(const DFA &dfa, int count, uint64_t seed)
+{
+    CorpusRng rng(seed);
+    vector<string> inputs = {""};
+    for (int i = 0; i < count; i++)
+    {
+        string input;
+        int state = dfa.startState();
+        while (input.size() < 24 && !rng.chance(8))
+        {
+            auto row = dfa.transitions().find(state);
+            if (row == dfa.transitions().end() || row->second.empty() || rng.chance(5))
+            {
+                input += char(rng.below(256));
+                continue;
+            }
+            auto edge = next(row->second.begin(), rng.below(row->second.size()));
+            input += edge->first;
+            state = edge->second;
+        }
+        inputs.push_back(input);
+    }
+    return inputs;
+}
+
+void testDFACompile()
+{
+    CorpusRng rng(seedFor(0));
+    vector<pair<string, DFA>> dfas;
+    for (int states : {1, 16, 200})
+        dfas.push_back({"complete:" + to_string(states), generateDFA(states, 4, seedFor(states))});
+    // Sparse DFAs over arbitrary bytes and state ids, with accepting and
+    // start states that have no edges.
+    for (int i = 0; i < 100; i++)
+    {
+        DFA dfa;
+        int states = 1 + rng.below(40);
+        string alphabet;
+        for (int k = 1 + rng.below(8); k > 0; k--)
+            alphabet += char(rng.below(256));
+        auto randomState = [&] { return int(rng.below(states + 4)) - 2; };
+        dfa.setStartState(randomState());
+        for (int s = -2; s < states + 2; s++)
+        {
+            for (char c : alphabet)
+                if (rng.chance(50))
+                    dfa.addTransition(s, c, randomState());
+            if (rng.chance(30))
+                dfa.addAcceptState(s);
+        }
+        dfas.push_back({"sparse:" + to_string(i), dfa});
+    }
+
+    for (auto &[name, reference] : dfas)
+    {
+        DFA compiled = reference;
+        compiled.compile();
+        for (const string &input : sampleWalks(reference, 300, seedFor(reference.transitions().size())))
+            check(compiled.isAccepted(input) == reference.isAccepted(input), name + " input of " + to_string(input.size()) + " bytes");
+
+        // An edit after compile() must not leave the old table in use.
+        int from = reference.startState();
+        char symbol = char(rng.below(256));
+        int to = int(rng.below(8)) - 2;
+        reference.addTransition(from, symbol, to);
+        compiled.addTransition(from, symbol, to);
+        reference.addAcceptState(to);
+        compiled.addAcceptState(to);
+        check(compiled.isAccepted(string(1, symbol)) && reference.isAccepted(string(1, symbol)), name + " edit after compile");
+        for (const string &input : sampleWalks(reference, 50, seedFor(1)))
+            check(compiled.isAccepted(input) == reference.isAccepted(input), name + " input after an edit");
+    }
+}
+
+void testGeneratedMatchers()
+{
+    // The bench build generates these headers from generateDFA(states, 4, 42).
+    struct Generated
+    {
+        const char *name;
+        int states;
+        bool (*matches)(string_view);
+    };
+    for (const Generated &generated : {Generated{"dfa16_switch", 16, matchDFA16_switch}, Generated{"dfa16_table", 16, matchDFA16_table},
+                                       Generated{"dfa1024_switch", 1024, matchDFA1024_switch},
+                                       Generated{"dfa1024_table", 1024, matchDFA1024_table}})
+    {
+        DFA reference = generateDFA(generated.states, 4, 42);
+        for (const string &input : sampleWalks(reference, 5000, seedFor(generated.states)))
+            check(generated.matches(input) == reference.isAccepted(input),
+                  string(generated.name) + " input of " + to_string(input.size()) + " bytes");
+    }
+}
+
+// Reference recognizer for any context-free grammar, ε-productions and
+// cycles included: derives[A][i][j] says whether nonterminal A derives
+// tokens[i..j), grown to a fixed point. Slow, but sentences are short.
+bool derives(const Grammar &grammar, const vector<uint32_t> &tokens)
+{
+    size_t n = tokens.size();
+    vector<vector<vector<bool>>> table(grammar.nonTerminalCount(), vector<vector<bool>>(n + 1, vector<bool>(n + 1, false)));
+    for (bool changed = true; changed;)
+    {
+        changed = false;
+        for (const Grammar::Production &production : grammar.productions)
+        {
+            vector<vector<bool>> &head = table[grammar.index[production.head]];
+            for (size_t i = 0; i <= n; i++)
+            {
+                vector<bool> at(n + 1, false); // where a prefix of the body can end
+                at[i] = true;
+                for (uint32_t symbol : production.body)
+                {
+                    vector<bool> after(n + 1, false);
+                    for (size_t p = i; p <= n; p++)
+                    {
+                        if (!at[p])
+                            continue;
+                        if (!grammar.isNonTerminal[symbol])
+                        {
+                            if (p < n && tokens[p] == symbol)
+                                after[p + 1] = true;
+                        }
+                        else
+                            for (size_t q = p; q <= n; q++)
+                                if (table[grammar.index[symbol]][p][q])
+                                    after[q] = true;
+                    }
+                    at = move(after);
+                }
+                for (size_t j = i; j <= n; j++)
+                {
+                    if (at[j] && !head[i][j])
+                    {
+                        head[i][j] = true;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+    return grammar.start != UINT32_MAX && table[grammar.index[grammar.start]][0][n];
+}
+
+// Applies `productions` to the start symbol, each to the leftmost (or
+// rightmost) nonterminal, and checks that the result is `tokens`.
+bool replays(const Grammar &grammar, const vector<uint32_t> &productions, bool leftmost, const vector<uint32_t> &tokens)
+{
+    vector<uint32_t> form = {grammar.start};
+    for (uint32_t number : productions)
+    {
+        size_t at = form.size();
+        for (size_t i = 0; i < form.size(); i++)
+            if (grammar.isNonTerminal[form[i]] && (at == form.size() || !leftmost))
+                at = i;
+        const Grammar::Production &production = grammar.productions[number];
+        if (at == form.size() || form[at] != production.head)
+            return false;
+        form.erase(form.begin() + at);
+        form.insert(form.begin() + at, production.body.begin(), production.body.end());
+    }
+    return form == tokens;
+}
+
+// Sentences as terminal names: random leftmost derivations of `grammar`,
+// each followed by a copy with one terminal inserted, replaced or deleted.
+vector<vector<string>> sampleSentences(const Grammar &grammar, int count, uint64_t seed)
+{
+    CorpusRng rng(seed);
+    vector<string> alphabet;
+    for (uint32_t terminal : grammar.terminals)
+        if (terminal != Grammar::endMarker)
+            alphabet.push_back(string(grammar.name(terminal)));
+    vector<vector<string>> sentences = {{}};
+    for (int attempt = 0; attempt < 20 * count && int(sentences.size()) < 2 * count; attempt++)
+    {
+        vector<uint32_t> form = {grammar.start};
+        size_t at = 0;
+        for (int step = 0; step < 100 && at < form.size() && form.size() <= 12; step++)
+        {
+            const vector<uint32_t> &numbers = grammar.rules[grammar.index[form[at]]];
+            if (numbers.empty())
+                break;
+            const vector<uint32_t> &body = grammar.productions[numbers[rng.below(numbers.size())]].body;
+            form.erase(form.begin() + at);
+            form.insert(form.begin() + at, body.begin(), body.end());
+            while (at < form.size() && !grammar.isNonTerminal[form[at]])
+                at++;
+        }
+        if (at < form.size())
+            continue; // gave up on this derivation
+        vector<string> sentence;
+        for (uint32_t symbol : form)
+            sentence.push_back(string(grammar.name(symbol)));
+        sentences.push_back(sentence);
+        if (alphabet.empty())
+            continue;
+        size_t position = rng.below(sentence.size() + 1);
+        string terminal = alphabet[rng.below(alphabet.size())];
+        if (position == sentence.size() || rng.chance(33))
+            sentence.insert(sentence.begin() + position, terminal);
+        else if (rng.chance(50))
+            sentence[position] = terminal;
+        else
+            sentence.erase(sentence.begin() + position);
+        sentences.push_back(sentence);
+    }
+    return sentences;
+}
+
+// Terminal ids of `sentence` in `grammar`; false if a name is not a terminal there.
+bool tokensIn(const Grammar &grammar, const vector<string> &sentence, vector<uint32_t> &tokens)
+{
+    tokens.clear();
+    for (const string &name : sentence)
+    {
+        uint32_t id = grammar.find(name);
+        if (id == UINT32_MAX || id == Grammar::endMarker || grammar.isNonTerminal[id])
+            return false;
+        tokens.push_back(id);
+    }
+    return true;
+}
+
+string describeSentence(const vector<string> &sentence)
+{
+    string text;
+    for (const string &name : sentence)
+        text += (text.empty() ? "" : " ") + name;
+    return "\"" + text + "\"";
+}
+
+// Small generated grammars, with and without left recursion, plus the
+// expression grammars the labs use.
+vector<pair<string, Grammar>> sampleGrammars()
+{
+    vector<pair<string, Grammar>> grammars;
+    grammars.push_back({"E/T/F", Grammar::fromRules({{"E", {"E+T", "T"}}, {"T", {"T*F", "F"}}, {"F", {"(E)", "i"}}}, "E")});
+    grammars.push_back({"E/T/F LL(1)", Grammar::fromRules({{"E", {"TX"}}, {"X", {"+TX", "ε"}}, {"T", {"FY"}}, {"Y", {"*FY", "ε"}}, {"F", {"(E)", "i"}}}, "E")});
+    grammars.push_back({"nullable", Grammar::fromRules({{"S", {"ABc", "d"}}, {"A", {"a", "ε"}}, {"B", {"b", "ε"}}}, "S")});
+    grammars.push_back({"operators", Grammar::fromRules(generateOperatorGrammar(3, 2), "E0")});
+    for (int i = 0; i < 40; i++)
+        grammars.push_back({"generated:" + to_string(i), Grammar::fromRules(generateGrammar(2 + i % 5, 3, 4, seedFor(i), i % 2 == 0))});
+    return grammars;
+}
+
+void testLeftFactoring()
+{
+    for (const auto &[name, grammar] : sampleGrammars())
+    {
+        Grammar factored = leftFactor(grammar);
+        for (uint32_t nt = 0; nt < factored.nonTerminalCount(); nt++)
+        {
+            set<uint32_t> leads;
+            bool distinct = true;
+            for (uint32_t number : factored.rules[nt])
+                if (!factored.productions[number].body.empty())
+                    distinct &= leads.insert(factored.productions[number].body[0]).second;
+            check(distinct, name + " " + string(factored.name(factored.nonTerminals[nt])) + " still has a common prefix");
+        }
+        vector<uint32_t> tokens, factoredTokens;
+        for (const vector<string> &sentence : sampleSentences(grammar, 100, seedFor(grammar.productions.size())))
+            if (tokensIn(grammar, sentence, tokens) && tokensIn(factored, sentence, factoredTokens))
+                check(derives(factored, factoredTokens) == derives(grammar, tokens), name + " " + describeSentence(sentence));
+    }
+}
+
+void testLeftRecursion()
+{
+    for (const auto &[name, grammar] : sampleGrammars())
+    {
+        // None of the samples has ε-productions in a left corner or cycles,
+        // so every left-corner component must end up a single nonterminal.
+        Grammar converted = eliminateLeftRecursion(grammar);
+        vector<uint32_t> component = leftCornerComponents(converted);
+        check(set<uint32_t>(component.begin(), component.end()).size() == component.size(), name + " left-corner cycle left");
+        for (const Grammar::Production &production : converted.productions)
+            check(production.body.empty() || production.body[0] != production.head, name + " direct left recursion left");
+
+        vector<uint32_t> tokens, convertedTokens;
+        for (const vector<string> &sentence : sampleSentences(grammar, 100, seedFor(grammar.productions.size())))
+            if (tokensIn(grammar, sentence, tokens) && tokensIn(converted, sentence, convertedTokens))
+                check(derives(converted, convertedTokens) == derives(grammar, tokens), name + " " + describeSentence(sentence));
+    }
+}
+
+void testLL1()
+{
+    vector<pair<string, Grammar>> grammars = sampleGrammars();
+    // Factored and left-recursion-free versions are often LL(1).
+    for (size_t i = 0, n = grammars.size(); i < n; i++)
+        grammars.push_back({grammars[i].first + " rewritten", eliminateLeftRecursion(leftFactor(grammars[i].second))});
+    grammars.push_back({"left-recursive", Grammar::fromRules({{"E", {"E+i", "i"}}}, "E")});
+
+    int ll1 = 0;
+    for (const auto &[name, grammar] : grammars)
+    {
+        LL1Table table = buildLL1Table(grammar, computeFirstFollowSets(grammar));
+        ll1 += table.isLL1();
+        vector<uint32_t> tokens, derivation;
+        for (const vector<string> &sentence : sampleSentences(grammar, 100, seedFor(grammar.productions.size())))
+        {
+            if (!tokensIn(grammar, sentence, tokens))
+                continue;
+            derivation.clear();
+            bool accepted = predictiveParse(grammar, table, tokens, &derivation);
+            string what = name + " " + describeSentence(sentence);
+            if (!table.isLL1())
+            {
+                check(!accepted, what + " parsed with a conflicted table");
+                continue;
+            }
+            check(accepted == derives(grammar, tokens), what);
+            check(!accepted || replays(grammar, derivation, true, tokens), what + " derivation");
+        }
+    }
+    check(ll1 >= 4, "only " + to_string(ll1) + " sample grammars are LL(1)");
+}
+
+void testLALR()
+{
+    vector<pair<string, Grammar>> grammars = sampleGrammars();
+    // Conflicted tables that used to crash or hang the driver.
+    grammars.push_back({"S -> S | a", Grammar::fromRules({{"S", {"S", "a"}}}, "S")});
+    grammars.push_back({"S -> A, A -> S | a", Grammar::fromRules({{"S", {"A"}}, {"A", {"S", "a"}}}, "S")});
+    grammars.push_back({"A -> B, B -> A", Grammar::fromRules({{"S", {"aA"}}, {"A", {"B", "b"}}, {"B", {"A"}}}, "S")});
+
+    int lalr = 0;
+    for (const auto &[name, grammar] : grammars)
+    {
+        LALRTable table = buildLALRTable(grammar, computeFirstFollowSets(grammar));
+        lalr += table.isLALR1();
+        vector<uint32_t> tokens, reductions;
+        for (const vector<string> &sentence : sampleSentences(grammar, 100, seedFor(grammar.productions.size())))
+        {
+            if (!tokensIn(grammar, sentence, tokens))
+                continue;
+            reductions.clear();
+            bool accepted = lalrParse(grammar, table, tokens, &reductions);
+            string what = name + " " + describeSentence(sentence);
+            // A conflicted table still only accepts sentences, along a valid derivation.
+            if (table.isLALR1() || accepted)
+                check(accepted == derives(grammar, tokens), what);
+            vector<uint32_t> rightmost(reductions.rbegin(), reductions.rend());
+            check(!accepted || replays(grammar, rightmost, false, tokens), what + " reductions");
+        }
+    }
+    check(lalr >= 4, "only " + to_string(lalr) + " sample grammars are LALR(1)");
+}
+
+void testPrattParser()
+{
+    PrattParser pratt;
+    RecursiveDescentParser recursiveDescent;
+    ExpressionTree tree, reparsed;
+    CorpusRng rng(seedFor(0));
+
+    // Single-digit operands with + * and parentheses are the language both
+    // parsers accept; half the inputs get one byte replaced.
+    for (int i = 0; i < 5000; i++)
+    {
+        string expr = generateExpression(1 + rng.below(20), 6, rng.next());
+        if (rng.chance(50))
+            expr[rng.below(expr.size())] = "+*()7"[rng.below(5)];
+        bool multiDigit = false;
+        for (size_t k = 1; k < expr.size(); k++)
+            multiDigit |= isdigit((unsigned char)expr[k - 1]) && isdigit((unsigned char)expr[k]);
+        if (!multiDigit)
+            check(pratt.parse(expr, tree) == recursiveDescent.parse(expr), "\"" + expr + "\" accepted by only one parser");
+    }
+
+    // The full grammar: the value survives foldConstants() and a reparse of toString().
+    const unordered_map<string, long long> variables = {{"x", 7}, {"y", -3}};
+    for (int i = 0; i < 5000; i++)
+    {
+        string expr;
+        for (char c : generateExpression(1 + rng.below(20), 6, rng.next()))
+        {
+            if (c == '+' || c == '*')
+                expr += "+-*/%"[rng.below(5)];
+            else if (!isdigit((unsigned char)c))
+                expr += c;
+            else if (rng.chance(20))
+                expr += rng.chance(50) ? "-x" : "y";
+            else
+                expr += to_string(rng.below(rng.chance(50) ? 10 : 100000));
+        }
+        string what = "\"" + expr + "\"";
+        if (!pratt.parse(expr, tree))
+        {
+            check(false, what + " rejected");
+            continue;
+        }
+        long long value = 0, again = 0, folded = 0;
+        string error, againError, foldedError;
+        bool ok = tree.evaluate(variables, value, &error);
+        check(pratt.parse(tree.toString(), reparsed), what + " does not reparse from " + tree.toString());
+        bool againOk = reparsed.evaluate(variables, again, &againError);
+        tree.foldConstants();
+        bool foldedOk = tree.evaluate(variables, folded, &foldedError);
+        check(againOk == ok && againError == error && (!ok || again == value), what + " changes when reparsed");
+        check(foldedOk == ok && foldedError == error && (!ok || folded == value), what + " changes under foldConstants");
+    }
+
+    // Pratt has no depth limit; recursive descent stops at maxNesting.
+    size_t limit = RecursiveDescentParser::maxNesting;
+    check(pratt.parse(generateNestedExpression(100000), tree), "100000 nested parentheses");
+    check(recursiveDescent.parse(generateNestedExpression(limit)), "nesting at the limit");
+    check(!recursiveDescent.parse(generateNestedExpression(100000)) && recursiveDescent.errorOffset() == limit,
+          "nesting past the limit");
+}
+
+void testBatchValidator()
+{
+    // After the corpus lines: nesting deep enough to overflow a worker's
+    // stack without the depth limit, then CRLF, empty and unterminated lines.
+    string text = generateExpressionLines(3000, seedFor(0)) + generateNestedExpression(3000000) + "\n\r\n\n1+2\r\n(3";
+    for (BatchValidator::Grammar grammar : {BatchValidator::RECURSIVE_DESCENT, BatchValidator::PRATT})
+    {
+        RecursiveDescentParser recursiveDescent;
+        PrattParser pratt;
+        ExpressionTree tree;
+        vector<BatchValidator::LineResult> expected;
+        for (size_t start = 0; start < text.size();)
+        {
+            size_t end = min(text.find('\n', start), text.size());
+            string_view line = string_view(text).substr(start, end - start);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            bool valid = grammar == BatchValidator::PRATT ? pratt.parse(line, tree) : recursiveDescent.parse(line);
+            size_t offset = grammar == BatchValidator::PRATT ? pratt.errorOffset() : recursiveDescent.errorOffset();
+            expected.push_back({valid, valid ? 0 : uint32_t(offset)});
+            start = end + 1;
+        }
+
+        for (unsigned threads : {1, 2, 3, 8})
+        {
+            for (size_t batchBytes : {size_t(64), size_t(4096), size_t(1) << 20})
+            {
+                istringstream in(text);
+                vector<pair<size_t, BatchValidator::LineResult>> results;
+                size_t lines = BatchValidator(threads, grammar, batchBytes)
+                                   .validate(in, [&](size_t line, BatchValidator::LineResult result) { results.push_back({line, result}); });
+                string what = string(grammar == BatchValidator::PRATT ? "pratt" : "recursive descent") + " threads:" +
+                              to_string(threads) + " batch:" + to_string(batchBytes);
+                bool same = lines == expected.size() && results.size() == expected.size();
+                for (size_t i = 0; same && i < results.size(); i++)
+                    same = results[i].first == i + 1 && results[i].second.valid == expected[i].valid &&
+                           results[i].second.errorOffset == expected[i].errorOffset;
+                check(same, what);
+            }
+        }
+    }
+}
+
+void testAhoCorasick()
+{
+    CorpusRng rng(seedFor(0));
+    vector<pair<string, vector<string>>> patternSets = {
+        {"tokens", {"int", "if", "while", "return", "for", "=", "==", "+", "++", "//", "\"", "in"}}};
+    // Random words over a-c, empty and repeated ones included.
+    for (int count : {1, 5, 40})
+    {
+        vector<string> words;
+        for (int i = 0; i < count; i++)
+        {
+            string word;
+            for (int length = rng.below(6); length > 0; length--)
+                word += char('a' + rng.below(3));
+            words.push_back(word);
+        }
+        patternSets.push_back({"words:" + to_string(count), words});
+    }
+    string letters;
+    for (int i = 0; i < 4000; i++)
+        letters += char('a' + rng.below(4));
+    vector<string> texts = {"", "a", letters, generateSource(1 << 12, seedFor(1))};
+
+    for (const auto &[name, patterns] : patternSets)
+    {
+        AhoCorasick matcher(vector<string_view>(patterns.begin(), patterns.end()));
+        vector<uint32_t> distinct; // the first id of every non-empty pattern
+        for (uint32_t id = 0; id < patterns.size(); id++)
+            if (!patterns[id].empty() && find(patterns.begin(), patterns.begin() + id, patterns[id]) == patterns.begin() + id)
+                distinct.push_back(id);
+
+        for (const string &text : texts)
+        {
+            string what = name + " text of " + to_string(text.size()) + " bytes";
+            vector<pair<size_t, uint32_t>> found, expected;
+            auto collect = [&](size_t offset, uint32_t id) { found.push_back({offset, id}); };
+
+            // Every occurrence by end offset, longest first.
+            for (size_t end = 1; end <= text.size(); end++)
+                for (size_t start = 0; start < end; start++)
+                    for (uint32_t id : distinct)
+                        if (patterns[id].size() == end - start && text.compare(start, end - start, patterns[id]) == 0)
+                            expected.push_back({start, id});
+            size_t count = matcher.scan(text, collect);
+            check(found == expected && count == expected.size(), what + " overlapping");
+
+            // Longest match at the leftmost start, then resume after it.
+            found.clear();
+            expected.clear();
+            for (size_t i = 0; i < text.size();)
+            {
+                uint32_t best = AhoCorasick::NONE;
+                for (uint32_t id : distinct)
+                    if ((best == AhoCorasick::NONE || patterns[id].size() > patterns[best].size()) &&
+                        text.compare(i, patterns[id].size(), patterns[id]) == 0)
+                        best = id;
+                if (best == AhoCorasick::NONE)
+                {
+                    i++;
+                    continue;
+                }
+                expected.push_back({i, best});
+                i += patterns[best].size();
+            }
+            count = matcher.scan(text, collect, AhoCorasick::LEFTMOST_LONGEST);
+            check(found == expected && count == expected.size(), what + " leftmost-longest");
+        }
+    }
+}
+
+void testIncrementalLexer()
+{
+    CorpusRng rng(seedFor(0));
+    string snippets = generateSource(1 << 12, seedFor(1));
+    for (size_t blockTokens : {1, 4, 256})
+    {
+        string text = generateSource(1 << 14, seedFor(2));
+        IncrementalLexer incremental(blockTokens);
+        incremental.analyze(text);
+        for (int edit = 0; edit < 300; edit++)
+        {
+            size_t offset = rng.below(text.size() + 1);
+            size_t deleted = rng.below(min<size_t>(64, text.size() - offset) + 1);
+            string inserted = rng.chance(20) ? string(1, "\"/\n "[rng.below(4)]) : snippets.substr(rng.below(snippets.size()), rng.below(64));
+            text.replace(offset, deleted, inserted);
+            incremental.edit(offset, deleted, inserted);
+
+            LexicalAnalyzer full;
+            full.analyze(text);
+            const TokenBuffer &expected = full.tokenBuffer();
+            TokenBuffer tokens = incremental.tokenBuffer();
+            string what = "block tokens:" + to_string(blockTokens) + " edit " + to_string(edit);
+            check(incremental.text() == text, what + " text");
+            check(tokens.kinds == expected.kinds, what + " kinds");
+            check(tokens.offsets == expected.offsets, what + " offsets");
+            check(tokens.lengths == expected.lengths, what + " lengths");
+            check(tokens.lines == expected.lines, what + " lines");
+            bool sameNames = tokens.size() == expected.size();
+            for (size_t i = 0; sameNames && i < tokens.size(); i++)
+                sameNames = incremental.symbolTable().name(tokens.symbols[i]) == full.symbolTable().name(expected.symbols[i]);
+            check(sameNames, what + " symbols");
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const vector<pair<string, void (*)()>> groups = {
+        {"subset", testSubsetConstruction}, {"matchers", testMatchers},   {"compile", testDFACompile},
+        {"codegen", testGeneratedMatchers}, {"image", testDFAImage},      {"lexer", testParallelLexer},
+        {"incremental", testIncrementalLexer}, {"aho-corasick", testAhoCorasick}, {"pratt", testPrattParser},
+        {"batch", testBatchValidator},      {"factoring", testLeftFactoring}, {"recursion", testLeftRecursion},
+        {"ll1", testLL1},                   {"lalr", testLALR}};
+    string group = argc > 1 ? argv[1] : "";
+    auto it = find_if(groups.begin(), groups.end(), [&](const pair<string, void (*)()> &entry) { return entry.first == group; });
+    if (it == groups.end())
+    {
+        cerr << "Usage: " << argv[0] << " <group>, one of:";
+        for (const auto &entry : groups)
+            cerr << " " << entry.first;
+        cerr << "\n";
+        return 2;
+    }
+    it->second();
+    if (failures)
+        cerr << failures << " checks failed\n";
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,442 @@
+#pragma once
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <unordered_set>
+#include <unordered_map>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+#include "platform.h"
+#include "token_buffer.h"
+#include "perfect_hash.h"
+#include "aho_corasick.h"
+#include "metrics.h"
+
+// Bulk character-class kernels for the tokenizer hot loops. best() is the
+// default for tokenize; the scalar variant is the reference and handles
+// block tails.
+class CharClassKernels
+{
+public:
+    const char *name;
+    size_t (*skipWhitespace)(const char *text, size_t i, size_t n);
+    size_t (*skipIdentifier)(const char *text, size_t i, size_t n);
+
+    static bool isWhitespace(unsigned char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+    static bool isIdentifier(unsigned char c) { return isalnum(c) || c == '_'; }
+
+    static const CharClassKernels &scalar()
+    {
+        static const CharClassKernels kernels = {"scalar", skipWhitespaceScalar, skipIdentifierScalar};
+        return kernels;
+    }
+
+#ifdef CDLAB_X86
+    static const CharClassKernels &sse2()
+    {
+        static const CharClassKernels kernels = {"sse2", skipWhitespaceSSE2, skipIdentifierSSE2};
+        return kernels;
+    }
+
+    // Falls back to sse2() on CPUs without AVX2; check name to see which ran.
+    static const CharClassKernels &avx2()
+    {
+        static const CharClassKernels kernels = __builtin_cpu_supports("avx2")
+                                                    ? CharClassKernels{"avx2", skipWhitespaceAVX2, skipIdentifierAVX2}
+                                                    : sse2();
+        return kernels;
+    }
+#endif
+
+    // SSE2 on x86: source text has short whitespace and identifier runs, so
+    // the 16-byte kernel beats the 32-byte one, which mostly ends up in its
+    // tail (CharClassKernels/* benchmarks: 0.24 vs 0.18 bytes/cycle).
+    static const CharClassKernels &best()
+    {
+#ifdef CDLAB_X86
+        return sse2();
+#else
+        return scalar();
+#endif
+    }
+
+private:
+    static size_t skipWhitespaceScalar(const char *text, size_t i, size_t n)
+    {
+        while (i < n && isWhitespace(text[i]))
+            i++;
+        return i;
+    }
+
+    static size_t skipIdentifierScalar(const char *text, size_t i, size_t n)
+    {
+        while (i < n && isIdentifier(text[i]))
+            i++;
+        return i;
+    }
+
+#ifdef CDLAB_X86
+    // lo <= v <= hi as unsigned bytes.
+    static __m128i inRange(__m128i v, char lo, char hi)
+    {
+        __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+        return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(char(hi - lo))), shifted);
+    }
+
+    static uint32_t whitespace16(__m128i v)
+    {
+        __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), inRange(v, '\t', '\r'));
+        return _mm_movemask_epi8(space);
+    }
+
+    static uint32_t identifier16(__m128i v)
+    {
+        __m128i letter = inRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+        __m128i digit = inRange(v, '0', '9');
+        __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+        return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(letter, digit), underscore));
+    }
+
+    static size_t skipWhitespaceSSE2(const char *text, size_t i, size_t n)
+    {
+        for (; i + 16 <= n; i += 16)
+        {
+            uint32_t stop = ~whitespace16(_mm_loadu_si128((const __m128i *)(text + i))) & 0xFFFF;
+            if (stop)
+                return i + __builtin_ctz(stop);
+        }
+        return skipWhitespaceScalar(text, i, n);
+    }
+
+    static size_t skipIdentifierSSE2(const char *text, size_t i, size_t n)
+    {
+        for (; i + 16 <= n; i += 16)
+        {
+            uint32_t stop = ~identifier16(_mm_loadu_si128((const __m128i *)(text + i))) & 0xFFFF;
+            if (stop)
+                return i + __builtin_ctz(stop);
+        }
+        return skipIdentifierScalar(text, i, n);
+    }
+
+    __attribute__((target("avx2"))) static __m256i inRange256(__m256i v, char lo, char hi)
+    {
+        __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+        return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(char(hi - lo))), shifted);
+    }
+
+    __attribute__((target("avx2"))) static uint32_t whitespace32(__m256i v)
+    {
+        __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), inRange256(v, '\t', '\r'));
+        return _mm256_movemask_epi8(space);
+    }
+
+    __attribute__((target("avx2"))) static uint32_t identifier32(__m256i v)
+    {
+        __m256i letter = inRange256(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+        __m256i digit = inRange256(v, '0', '9');
+        __m256i underscore = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+        return _mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(letter, digit), underscore));
+    }
+
+    __attribute__((target("avx2"))) static size_t skipWhitespaceAVX2(const char *text, size_t i, size_t n)
+    {
+        for (; i + 32 <= n; i += 32)
+        {
+            uint32_t stop = ~whitespace32(_mm256_loadu_si256((const __m256i *)(text + i)));
+            if (stop)
+                return i + __builtin_ctz(stop);
+        }
+        return skipWhitespaceSSE2(text, i, n);
+    }
+
+    __attribute__((target("avx2"))) static size_t skipIdentifierAVX2(const char *text, size_t i, size_t n)
+    {
+        for (; i + 32 <= n; i += 32)
+        {
+            uint32_t stop = ~identifier32(_mm256_loadu_si256((const __m256i *)(text + i)));
+            if (stop)
+                return i + __builtin_ctz(stop);
+        }
+        return skipIdentifierSSE2(text, i, n);
+    }
+
+#endif
+};
+
+class TokenAnalyzer
+{
+public:
+    enum Category : uint8_t
+    {
+        KEYWORD,
+        OPERATOR,
+        PUNCTUATION,
+        IDENTIFIER,
+        NUMERIC_LITERAL,
+        STRING_LITERAL,
+        UNKNOWN
+    };
+
+    // Fixed vocabularies; the lookup tables are generated from these lists
+    // at compile time.
+    static constexpr std::string_view keywordList[] = {
+        "int", "float", "double", "char", "void", "return",
+        "if", "else", "while", "for", "switch", "case",
+        "break", "continue", "const", "class", "struct", "main"};
+
+    static constexpr std::string_view operatorList[] = {
+        "+", "-", "*", "/", "%", "=", "==", "!=",
+        "<", ">", "<=", ">=", "&&", "||", "!",
+        "&", "|", "^", "~", "<<", ">>", "+=",
+        "-=", "*=", "/=", "%="};
+
+    static constexpr std::string_view punctuationList[] = {
+        "(", ")", "{", "}", ";", ","};
+
+    static constexpr auto keywords = makePerfectHashSet(keywordList);
+    static constexpr auto operators = makePerfectHashSet(operatorList);
+    static constexpr auto punctuations = makePerfectHashSet(punctuationList);
+
+    // Keywords and operators as one Aho-Corasick automaton for bulk scans of
+    // raw text. Pattern id i is keywordList[i] for i < size(keywordList), then
+    // operatorList[i - size(keywordList)]. Matches are substrings, so "int"
+    // is also found inside "print".
+    static const AhoCorasick &vocabularyMatcher()
+    {
+        static const AhoCorasick matcher = []()
+        {
+            std::vector<std::string_view> patterns(std::begin(keywordList), std::end(keywordList));
+            patterns.insert(patterns.end(), std::begin(operatorList), std::end(operatorList));
+            return AhoCorasick(patterns);
+        }();
+        return matcher;
+    }
+
+    static Category vocabularyCategory(uint32_t pattern)
+    {
+        return pattern < std::size(keywordList) ? KEYWORD : OPERATOR;
+    }
+
+private:
+
+    TokenBuffer tokens;
+    SymbolTable symbols;
+    uint32_t keywordSymbols = 0; // keywords are interned first, so ids below this are keywords
+
+    static bool isIdentifierStart(char c)
+    {
+        return isalpha((unsigned char)c) || c == '_';
+    }
+
+    static bool isIdentifierChar(char c)
+    {
+        return isalnum((unsigned char)c) || c == '_';
+    }
+
+    // Returns the end of the longest numeric literal starting at `start`
+    // (digits, optional fraction, optional exponent), or `start` if none.
+    static size_t scanNumber(const std::string &code, size_t start)
+    {
+        size_t i = start;
+        while (i < code.length() && isdigit((unsigned char)code[i]))
+            i++;
+        if (i == start)
+            return start;
+
+        if (i + 1 < code.length() && code[i] == '.' && isdigit((unsigned char)code[i + 1]))
+        {
+            i += 2;
+            while (i < code.length() && isdigit((unsigned char)code[i]))
+                i++;
+        }
+
+        if (i < code.length() && (code[i] == 'e' || code[i] == 'E'))
+        {
+            size_t j = i + 1;
+            if (j < code.length() && (code[j] == '+' || code[j] == '-'))
+                j++;
+            if (j < code.length() && isdigit((unsigned char)code[j]))
+            {
+                while (j < code.length() && isdigit((unsigned char)code[j]))
+                    j++;
+                i = j;
+            }
+        }
+        return i;
+    }
+
+    // Returns the end of a quoted literal starting at `start`, or npos if it
+    // is not terminated on the same line.
+    static size_t scanQuoted(const std::string &code, size_t start)
+    {
+        char quote = code[start];
+        for (size_t i = start + 1; i < code.length(); i++)
+        {
+            if (code[i] == '\\')
+                i++;
+            else if (code[i] == quote)
+                return i + 1;
+            else if (code[i] == '\n')
+                break;
+        }
+        return std::string::npos;
+    }
+
+public:
+    // Single pass, maximal munch: every token is classified as it is scanned
+    // and its text interned, so the token stream itself never allocates.
+    void tokenize(const std::string &code)
+    {
+        const CharClassKernels &kernels = CharClassKernels::best();
+        tokens.clear();
+        symbols.clear();
+        for (std::string_view keyword : keywordList)
+            symbols.intern(keyword);
+        keywordSymbols = symbols.size();
+
+        size_t i = 0;
+        uint32_t lineNumber = 1;
+        CDLAB_STOPWATCH(phases); // scan: finding token ends; classify: interning, keywords, storing
+
+        while (i < code.length())
+        {
+            char c = code[i];
+
+            if (CharClassKernels::isWhitespace(c))
+            {
+                size_t end = kernels.skipWhitespace(code.data(), i, code.length());
+                lineNumber += std::count(code.begin() + i, code.begin() + end, '\n');
+                i = end;
+                continue;
+            }
+
+            size_t start = i;
+            Category category;
+
+            if (isIdentifierStart(c))
+            {
+                i = kernels.skipIdentifier(code.data(), i, code.length());
+                category = IDENTIFIER;
+            }
+            else if (isdigit((unsigned char)c))
+            {
+                i = scanNumber(code, start);
+                category = NUMERIC_LITERAL;
+                if (i < code.length() && isIdentifierChar(code[i]))
+                {
+                    i = kernels.skipIdentifier(code.data(), i, code.length());
+                    category = UNKNOWN; // e.g. 10abc
+                }
+            }
+            else if (c == '"' || c == '\'')
+            {
+                size_t end = scanQuoted(code, start);
+                if (end == std::string::npos)
+                {
+                    i = code.find('\n', start);
+                    if (i == std::string::npos)
+                        i = code.length();
+                    category = UNKNOWN;
+                }
+                else
+                {
+                    i = end;
+                    category = isStringLiteral(std::string_view(code).substr(start, i - start)) ? STRING_LITERAL : UNKNOWN;
+                }
+            }
+            else if (i + 1 < code.length() && isOperator(std::string_view(code).substr(i, 2)))
+            {
+                i += 2;
+                category = OPERATOR;
+            }
+            else
+            {
+                i++;
+                std::string_view single(&code[start], 1);
+                category = isOperator(single)      ? OPERATOR
+                           : isPunctuation(single) ? PUNCTUATION
+                                                   : UNKNOWN;
+            }
+
+            CDLAB_LAP(phases, Metric::TOKEN_ANALYZER_SCAN_SECONDS);
+            uint32_t symbol = symbols.intern(std::string_view(code).substr(start, i - start));
+            if (category == IDENTIFIER && symbol < keywordSymbols)
+                category = KEYWORD;
+            tokens.push(category, symbol, start, i - start, lineNumber);
+            CDLAB_COUNT(metricAt(Metric::TOKEN_ANALYZER_TOKENS, category), 1);
+            CDLAB_LAP(phases, Metric::TOKEN_ANALYZER_CLASSIFY_SECONDS);
+        }
+        CDLAB_LAP(phases, Metric::TOKEN_ANALYZER_SCAN_SECONDS);
+    }
+
+    bool isKeyword(std::string_view token) const
+    {
+        return keywords.contains(token);
+    }
+
+    bool isOperator(std::string_view token) const
+    {
+        return operators.contains(token);
+    }
+
+    bool isPunctuation(std::string_view token) const
+    {
+        return punctuations.contains(token);
+    }
+
+    bool isIdentifier(const std::string &token)
+    {
+        if (token.empty() || !isIdentifierStart(token[0]))
+            return false;
+        for (char c : token)
+            if (!isIdentifierChar(c))
+                return false;
+        return true;
+    }
+
+    bool isNumericLiteral(const std::string &token)
+    {
+        return !token.empty() && scanNumber(token, 0) == token.length();
+    }
+
+    bool isStringLiteral(std::string_view token)
+    {
+        if (token.length() == 3 && token.front() == '\'' && token.back() == '\'')
+            return token[1] != '\n';
+        if (token.length() == 4 && token.front() == '\'' && token[1] == '\\' && token.back() == '\'')
+            return true; // escaped character
+        if (token.length() >= 2 && token.front() == '"' && token.back() == '"')
+            return token.find('\n') == std::string_view::npos;
+        return false;
+    }
+
+    static const char *categoryName(uint8_t category)
+    {
+        static const char *names[] = {"Keyword", "Operator", "Punctuation", "Identifier",
+                                       "Numeric Literal", "String Literal", "Unknown"};
+        return names[category];
+    }
+
+    const TokenBuffer &tokenBuffer() const { return tokens; }
+    const SymbolTable &symbolTable() const { return symbols; }
+
+    void analyzeTokens(const std::string &code)
+    {
+        tokenize(code);
+        printTokens();
+    }
+
+    void printTokens()
+    {
+        std::cout << "Token Analysis:\n";
+        for (size_t i = 0; i < tokens.size(); i++)
+        {
+            auto token = symbols.name(tokens.symbols[i]);
+            auto category = categoryName(tokens.kinds[i]);
+            std::cout << "Token: " << token << " | Category: " << category << std::endl;
+        }
+    }
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <string_view>
+
+// Bump allocator for symbol text. Memory is only released all at once.
+class BumpArena
+{
+    static constexpr size_t blockSize = 64 << 10;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char *cursor = nullptr;
+    size_t remaining = 0;
+
+public:
+    char *allocate(size_t size)
+    {
+        if (size > remaining)
+        {
+            size_t capacity = std::max(size, blockSize);
+            blocks.emplace_back(new char[capacity]);
+            cursor = blocks.back().get();
+            remaining = capacity;
+        }
+        char *result = cursor;
+        cursor += size;
+        remaining -= size;
+        return result;
+    }
+
+    std::string_view copy(std::string_view text)
+    {
+        char *dest = allocate(text.size());
+        memcpy(dest, text.data(), text.size());
+        return std::string_view(dest, text.size());
+    }
+
+    void clear()
+    {
+        blocks.clear();
+        cursor = nullptr;
+        remaining = 0;
+    }
+};
+
+// Interns token text to dense 32-bit ids. Strings live in the arena; the
+// lookup table is open addressing with linear probing.
+class SymbolTable
+{
+    static constexpr uint32_t empty = UINT32_MAX;
+
+    BumpArena arena;
+    std::vector<std::string_view> names;
+    std::vector<uint32_t> slots;
+
+    static size_t hash(std::string_view text)
+    {
+        uint64_t h = 1469598103934665603ull;
+        for (unsigned char c : text)
+        {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    void grow()
+    {
+        std::vector<uint32_t> old(std::max<size_t>(64, slots.size() * 2), empty);
+        old.swap(slots);
+        size_t mask = slots.size() - 1;
+        for (uint32_t id : old)
+        {
+            if (id == empty)
+                continue;
+            size_t i = hash(names[id]) & mask;
+            while (slots[i] != empty)
+                i = (i + 1) & mask;
+            slots[i] = id;
+        }
+    }
+
+public:
+    uint32_t intern(std::string_view text)
+    {
+        if ((names.size() + 1) * 2 > slots.size())
+            grow();
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(text) & mask;; i = (i + 1) & mask)
+        {
+            uint32_t id = slots[i];
+            if (id == empty)
+            {
+                id = names.size();
+                names.push_back(arena.copy(text));
+                slots[i] = id;
+                return id;
+            }
+            if (names[id] == text)
+                return id;
+        }
+    }
+
+    // Id of `text` if it was interned, otherwise UINT32_MAX.
+    uint32_t find(std::string_view text) const
+    {
+        if (slots.empty())
+            return empty;
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(text) & mask; slots[i] != empty; i = (i + 1) & mask)
+            if (names[slots[i]] == text)
+                return slots[i];
+        return empty;
+    }
+
+    std::string_view name(uint32_t id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+
+    void clear()
+    {
+        arena.clear();
+        names.clear();
+        slots.clear();
+    }
+};
+
+// Token stream laid out as parallel arrays: 21 bytes per token and no
+// per-token allocation. The kind is the owning analyzer's category enum.
+// Offsets are 64-bit so inputs past 4 GiB keep exact positions.
+class TokenBuffer
+{
+public:
+    std::vector<uint8_t> kinds;
+    std::vector<uint32_t> symbols; // id in the analyzer's SymbolTable
+    std::vector<uint64_t> offsets; // byte offset into the analyzed source
+    std::vector<uint32_t> lengths;
+    std::vector<uint32_t> lines;
+
+    size_t size() const { return kinds.size(); }
+
+    void push(uint8_t kind, uint32_t symbol, uint64_t offset, uint32_t length, uint32_t line)
+    {
+        kinds.push_back(kind);
+        symbols.push_back(symbol);
+        offsets.push_back(offset);
+        lengths.push_back(length);
+        lines.push_back(line);
+    }
+
+    void reserve(size_t count)
+    {
+        kinds.reserve(count);
+        symbols.reserve(count);
+        offsets.reserve(count);
+        lengths.reserve(count);
+        lines.reserve(count);
+    }
+
+    void clear()
+    {
+        kinds.clear();
+        symbols.clear();
+        offsets.clear();
+        lengths.clear();
+        lines.clear();
+    }
+};